@@ -6,3 +6,4 @@ void redRush();
 void blueRush();
 void skills();
 void skills1();
+void trajectoryTest();
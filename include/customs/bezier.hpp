@@ -0,0 +1,158 @@
+#pragma once
+
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include "customs/path.hpp"
+
+// Paths built straight from the cubic Bezier controls in a jerryio JSON trailer instead of
+// the point list exported above it. Curves are exact, so they can be sampled at whatever
+// spacing the follower wants, with analytic tangents and curvature.
+
+// One cubic in power form, p(t) = a t^3 + b t^2 + c t + d for t in [0, 1]
+struct CubicBezier {
+    float a[2], b[2], c[2], d[2];
+
+    CubicBezier(const float x[4], const float y[4]) {
+        const float* axis[2] = {x, y};
+        for (int i = 0; i < 2; i++) {
+            const float* p = axis[i];
+            a[i] = -p[0] + 3 * p[1] - 3 * p[2] + p[3];
+            b[i] = 3 * p[0] - 6 * p[1] + 3 * p[2];
+            c[i] = -3 * p[0] + 3 * p[1];
+            d[i] = p[0];
+        }
+    }
+
+    void point(float t, float& px, float& py) const {
+        px = ((a[0] * t + b[0]) * t + c[0]) * t + d[0];
+        py = ((a[1] * t + b[1]) * t + c[1]) * t + d[1];
+    }
+
+    void tangent(float t, float& dx, float& dy) const {
+        dx = (3 * a[0] * t + 2 * b[0]) * t + c[0];
+        dy = (3 * a[1] * t + 2 * b[1]) * t + c[1];
+    }
+
+    // Signed, positive turning left
+    float curvature(float t) const {
+        float dx, dy;
+        tangent(t, dx, dy);
+        float ddx = 6 * a[0] * t + 2 * b[0], ddy = 6 * a[1] * t + 2 * b[1];
+        float speed = std::hypot(dx, dy);
+        return speed == 0 ? 0 : (dx * ddy - dy * ddx) / (speed * speed * speed);
+    }
+
+    // Arc length estimate, the mean of the control polygon and the chord
+    float approximateLength() const {
+        float x[4], y[4];
+        for (int i = 0; i < 2; i++) {
+            float* p = i == 0 ? x : y;
+            p[0] = d[i];
+            p[1] = d[i] + c[i] / 3;
+            p[2] = d[i] + (2 * c[i] + b[i]) / 3;
+            p[3] = a[i] + b[i] + c[i] + d[i];
+        }
+        float polygon = std::hypot(x[1] - x[0], y[1] - y[0]) + std::hypot(x[2] - x[1], y[2] - y[1]) +
+                        std::hypot(x[3] - x[2], y[3] - y[2]);
+        return (polygon + std::hypot(x[3] - x[0], y[3] - y[0])) / 2;
+    }
+};
+
+struct BezierPath {
+    std::vector<CubicBezier> segments;
+    float speed = 1; // Fraction of full speed, jerryio's speed limit
+};
+
+// Number after the first `key` in [from, end), returns the position past it or nullptr
+inline const char* jsonNumber(const char* from, const char* end, const char* key, float& value) {
+    const char* p = jsonFind(from, end, key);
+    if (p == nullptr) return nullptr;
+    char* after;
+    value = std::strtof(p, &after);
+    return after;
+}
+
+// Reads the "controls" of every segment in the #PATH.JERRYIO-DATA trailer. Control
+// coordinates are in jerryio's unit of length, scaled to inches with "uol" and the unit in
+// the format string. Straight segments (two controls) become cubics with thirds as controls.
+inline BezierPath parseBezierPath(const asset& file, float driveRpm) {
+    BezierPath path;
+    const char* text = reinterpret_cast<const char*>(file.buf);
+    const char* end = text + file.size;
+
+    const char* json = jsonFind(text, end, "#PATH.JERRYIO-DATA ");
+    if (json == nullptr) return path;
+
+    float uol = 1, scale = 1;
+    jsonNumber(json, end, "\"uol\":", uol);
+    if (jsonFind(json, end, "(cm,") != nullptr) scale = 1 / 2.54f;
+    else if (jsonFind(json, end, "(mm,") != nullptr) scale = 1 / 25.4f;
+    scale *= uol;
+
+    const char* limit = jsonFind(json, end, "\"speedLimit\":");
+    float rpm;
+    if (limit != nullptr && jsonNumber(limit, end, "\"to\":", rpm) != nullptr) path.speed = std::fmin(rpm / driveRpm, 1);
+
+    const char* p = json;
+    while (true) {
+        const char* controls = jsonFind(p, end, "\"controls\":[");
+        if (controls == nullptr) break;
+        const char* close = static_cast<const char*>(std::memchr(controls, ']', end - controls));
+        if (close == nullptr) break;
+
+        float x[4], y[4];
+        int count = 0;
+        // control objects are flat, so each {...} is one control
+        for (const char* object = controls; count < 4; count++) {
+            object = static_cast<const char*>(std::memchr(object, '{', close - object));
+            if (object == nullptr) break;
+            const char* objectEnd = static_cast<const char*>(std::memchr(object, '}', close - object));
+            if (objectEnd == nullptr || jsonNumber(object, objectEnd, "\"x\":", x[count]) == nullptr ||
+                jsonNumber(object, objectEnd, "\"y\":", y[count]) == nullptr)
+                break;
+            x[count] *= scale;
+            y[count] *= scale;
+            object = objectEnd;
+        }
+        if (count == 2) {
+            x[3] = x[1], y[3] = y[1];
+            x[1] = (2 * x[0] + x[3]) / 3, y[1] = (2 * y[0] + y[3]) / 3;
+            x[2] = (x[0] + 2 * x[3]) / 3, y[2] = (y[0] + 2 * y[3]) / 3;
+            count = 4;
+        }
+        if (count == 4) path.segments.emplace_back(x, y);
+        p = close;
+    }
+    return path;
+}
+
+// Samples every segment at roughly `spacing` inches with forward differencing, three adds
+// per axis per point, and fills curvature from the analytic derivatives
+inline CompiledPath sampleBezierPath(const BezierPath& bezier, float spacing) {
+    CompiledPath path;
+    for (size_t s = 0; s < bezier.segments.size(); s++) {
+        const CubicBezier& curve = bezier.segments[s];
+        int steps = std::max(1, int(std::ceil(curve.approximateLength() / spacing)));
+        float h = 1.0f / steps;
+
+        float f[2], d1[2], d2[2], d3[2];
+        for (int i = 0; i < 2; i++) {
+            f[i] = curve.d[i];
+            d1[i] = (curve.a[i] * h + curve.b[i]) * h * h + curve.c[i] * h;
+            d2[i] = (6 * curve.a[i] * h + 2 * curve.b[i]) * h * h;
+            d3[i] = 6 * curve.a[i] * h * h * h;
+        }
+        // segments share end points, so later ones skip their first sample
+        for (int k = 0; k <= steps; k++) {
+            if (k > 0 || s == 0) path.push(f[0], f[1], bezier.speed, curve.curvature(k * h));
+            for (int i = 0; i < 2; i++) {
+                f[i] += d1[i];
+                d1[i] += d2[i];
+                d2[i] += d3[i];
+            }
+        }
+    }
+    return path;
+}
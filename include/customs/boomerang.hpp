@@ -0,0 +1,59 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include "customs/path.hpp"
+
+// Boomerang move to a pose: the robot chases a carrot set back from the target along its
+// heading by lead times the distance left, so the carrot slides onto the target as the robot
+// arrives square to it. Instead of running at maxSpeed until it is close, the speed comes
+// from the carrot geometry every tick: whatever keeps the arc to the carrot inside the
+// lateral acceleration limit and still lets the robot brake to a stop over what is left.
+// Within 7.5 in it drives straight at the target and PD on turnConstants squares it up.
+
+struct BoomerangParams {
+    bool forwards = true;
+    float lead = 0.6;
+    float maxSpeed = 127; // out of 127
+    float minSpeed = 0; // out of 127, exits at earlyExitRange carrying it
+    float earlyExitRange = 0; // inches
+    float maxLateralAcceleration = 0; // in/s^2, 0 to use followConstants
+};
+
+// Target of one boomerang motion. The heading's sin and cos are worked out once here, the
+// carrot only needs them scaled by the distance each tick
+class BoomerangTarget {
+public:
+    // theta is the heading of travel at the target, compass degrees
+    BoomerangTarget(float x, float y, float theta, float lead)
+        : x(x), y(y), sinTheta(std::sin(theta * float(M_PI) / 180)), cosTheta(std::cos(theta * float(M_PI) / 180)),
+          lead(lead) {}
+
+    float distance(float px, float py) const { return std::hypot(x - px, y - py); }
+
+    void carrot(float px, float py, float& cx, float& cy) const {
+        float back = lead * distance(px, py);
+        cx = x - back * sinTheta;
+        cy = y - back * cosTheta;
+    }
+
+    float x, y, sinTheta, cosTheta, lead;
+};
+
+// Curvature of the arc leaving (px, py) along the compass heading given by its sin and cos
+// and passing through (tx, ty). Positive turns clockwise, like lemlib::getCurvature
+inline float arcCurvature(float px, float py, float sinHeading, float cosHeading, float tx, float ty) {
+    float dx = tx - px, dy = ty - py;
+    float chord = dx * dx + dy * dy;
+    if (chord < 1e-6f) return 0;
+    return 2 * (dx * cosHeading - dy * sinHeading) / chord;
+}
+
+// Speed cap in in/s for a tick that curves by `curvature` with `remaining` inches still to go
+inline float boomerangSpeed(float curvature, float remaining, float maxVelocity, float maxAcceleration, float maxLateralAcceleration) {
+    float cornering = curvature == 0 ? INFINITY : std::sqrt(maxLateralAcceleration / std::fabs(curvature));
+    return std::min({maxVelocity, cornering, std::sqrt(2 * maxAcceleration * remaining)});
+}
+
+// Blocks until the robot settles on the pose by lateralSettle, exits at speed or times out
+void boomerangToPose(float x, float y, float theta, int timeout, BoomerangParams params = {});
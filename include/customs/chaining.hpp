@@ -0,0 +1,35 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include "customs/path.hpp"
+
+// Plans how a move hands off to the move after it from the geometry of the two legs. The
+// robot exits `range` inches short of the corner, where an arc tangent to both legs takes
+// it onto the next one, so the exit speed is whatever keeps that arc inside the lateral
+// acceleration limit and still leaves the next leg room to brake to a stop.
+struct Handoff {
+    float speed = 0; // out of 127, 0 to settle
+    float range = 0; // early exit distance, inches
+};
+
+// in is this leg's direction of travel scaled to its length, out the next leg's. maxSpeed is
+// the lower of the two moves' caps, out of 127
+inline Handoff planHandoff(float inX, float inY, float outX, float outY, float maxSpeed, const PathLimits& limits) {
+    float inLength = std::hypot(inX, inY), outLength = std::hypot(outX, outY);
+    if (inLength < 1 || outLength < 1) return {};
+    float cosine = (inX * outX + inY * outY) / (inLength * outLength);
+    // past 90 degrees a turn in place beats swinging through the corner
+    if (cosine <= 0) return {};
+
+    // exit a third of the way back along the shorter leg, the arc has to fit on both
+    float range = std::min({inLength / 3, outLength / 3, 12.0f});
+    float half = std::acos(std::min(cosine, 1.0f)) / 2;
+    float radius = half < 1e-3f ? INFINITY : range / std::tan(half);
+    float velocity = std::min({limits.maxVelocity * maxSpeed / 127, std::sqrt(limits.maxLateralAcceleration * radius),
+                               std::sqrt(2 * limits.maxAcceleration * outLength)});
+    float speed = velocity / limits.maxVelocity * 127;
+    // too slow to be worth cutting the corner over
+    if (speed < 20 || range < 2) return {};
+    return {speed, range};
+}
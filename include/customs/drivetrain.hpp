@@ -1,9 +1,11 @@
 #include "pros/adi.hpp"
+#include "pros/distance.hpp"
 #include "pros/imu.hpp"
 #include "pros/motor_group.hpp"
 #include "pros/rotation.hpp"
 #include "lemlib/chassis/chassis.hpp"
 #include "lemlib/chassis/trackingWheel.hpp"
+#include "customs/field.hpp"
 
 using namespace pros;
 using namespace lemlib;
@@ -18,6 +20,8 @@ extern Motor fastintake;
 
 extern Motor arm;
 extern Imu imu;
+extern Distance dist;
+extern SensorMount distMount;
 
 
 extern adi::Pneumatics clamp;
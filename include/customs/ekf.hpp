@@ -0,0 +1,147 @@
+#pragma once
+
+#include <cmath>
+#include "Eigen/Dense"
+#include "customs/field.hpp"
+#include "customs/timesync.hpp"
+
+// Extended Kalman filter over the robot's pose and velocity, [x, y, theta, v, omega] in
+// inches, compass radians, in/s and rad/s. Every sensor comes in as a measurement weighted by
+// its own noise instead of one source being trusted outright: the tracking wheels measure
+// v and omega through their offsets, the IMU measures omega, and the GPS and distance
+// sensors pull x, y and theta back when they disagree. All matrices are fixed size, so
+// nothing is allocated per update.
+
+struct FilterNoise {
+    float acceleration = 100; // in/s^2, how fast v can change unmodelled
+    float angularAcceleration = 10; // rad/s^2
+    float wheelRate = 2; // in/s, per tracking wheel
+    float gyroRate = 0.05; // rad/s
+    float range = 0.6; // inches, distance sensor
+    float gate = 9; // chi-squared per dimension, GPS and ranges further out than 3 sigma are rejected
+};
+
+class PoseFilter {
+public:
+    using State = Eigen::Matrix<float, 5, 1>;
+    using Covariance = Eigen::Matrix<float, 5, 5>;
+
+    explicit PoseFilter(FilterNoise noise = {}) : noise(noise) { reset(0, 0, 0); }
+
+    // Starts from a known pose at rest, sure of it to within `spread` inches and radians
+    void reset(float x, float y, float theta, float spread = 0.1f) {
+        state << x, y, theta, 0, 0;
+        covariance = Covariance::Identity() * spread * spread;
+    }
+
+    // Moves the position by a correction from outside the filter, keeping the velocity and
+    // how sure it is of both
+    void shift(float dx, float dy) {
+        state(0) += dx;
+        state(1) += dy;
+    }
+
+    float x() const { return state(0); }
+    float y() const { return state(1); }
+    float theta() const { return state(2); }
+    const Covariance& uncertainty() const { return covariance; }
+
+    // Drives the state forward dt seconds along an arc at its own v and omega
+    void predict(float dt) {
+        float s = std::sin(state(2)), c = std::cos(state(2)), v = state(3);
+        Covariance f = Covariance::Identity();
+        f(0, 2) = v * c * dt;
+        f(0, 3) = s * dt;
+        f(1, 2) = -v * s * dt;
+        f(1, 3) = c * dt;
+        f(2, 4) = dt;
+        state(0) += v * s * dt;
+        state(1) += v * c * dt;
+        state(2) += state(4) * dt;
+        covariance = f * covariance * f.transpose();
+        covariance(3, 3) += noise.acceleration * noise.acceleration * dt * dt;
+        covariance(4, 4) += noise.angularAcceleration * noise.angularAcceleration * dt * dt;
+    }
+
+    // Tracking wheel speeds in in/s. A wheel off the turning centre also sees the turn, with
+    // offsets as in lemlib::TrackingWheel
+    bool updateWheels(float verticalRate, float horizontalRate, float verticalOffset, float horizontalOffset) {
+        Eigen::Matrix<float, 2, 5> h = Eigen::Matrix<float, 2, 5>::Zero();
+        h(0, 3) = 1;
+        h(0, 4) = -verticalOffset;
+        h(1, 4) = -horizontalOffset;
+        Eigen::Vector2f residual(verticalRate - (state(3) - verticalOffset * state(4)), horizontalRate + horizontalOffset * state(4));
+        return update<2>(residual, h, Eigen::Vector2f::Constant(noise.wheelRate * noise.wheelRate).asDiagonal());
+    }
+
+    bool updateGyro(float rate) {
+        Eigen::Matrix<float, 1, 5> h = Eigen::Matrix<float, 1, 5>::Zero();
+        h(0, 4) = 1;
+        return update<1>(Eigen::Matrix<float, 1, 1>(rate - state(4)), h, Eigen::Matrix<float, 1, 1>(noise.gyroRate * noise.gyroRate));
+    }
+
+    // GPS position in inches and heading, with its reported error as the standard deviation
+    bool updateGps(float x, float y, float theta, float positionError, float headingError) {
+        return updateGps(x, y, theta, positionError, headingError, {state(0), state(1), state(2)});
+    }
+
+    // A late reading compared against `at`, the estimate when it was taken, with the
+    // correction applied now: odometry adds little error over a sensor's latency, so the
+    // estimate is off now by about what it was off then
+    bool updateGps(float x, float y, float theta, float positionError, float headingError, const PlanarPose& at) {
+        Eigen::Matrix<float, 3, 5> h = Eigen::Matrix<float, 3, 5>::Zero();
+        h(0, 0) = h(1, 1) = h(2, 2) = 1;
+        Eigen::Vector3f residual(x - at.x, y - at.y, std::remainder(theta - at.theta, 2 * float(M_PI)));
+        Eigen::Vector3f variance(positionError * positionError, positionError * positionError, headingError * headingError);
+        return update<3>(residual, h, variance.asDiagonal(), true);
+    }
+
+    // Distance sensor range in inches, expected to hit a field wall. Readings off a goal or
+    // another robot land outside the gate and are dropped, beams onto a wall stake are skipped
+    bool updateRange(float range, const SensorMount& mount) { return updateRange(range, mount, {state(0), state(1), state(2)}); }
+
+    bool updateRange(float range, const SensorMount& mount, const PlanarPose& at) {
+        float px, py, heading;
+        int wall;
+        sensorRay(at.x, at.y, at.theta, mount, px, py, heading);
+        float expected = wallRange(px, py, heading, &wall);
+        if (!std::isfinite(expected) || onWallStake(px, py, heading, expected, wall)) return false;
+        // the wall is a plane, so x and y enter linearly; theta by central difference
+        const float step = 1e-3f;
+        Eigen::Matrix<float, 1, 5> h = Eigen::Matrix<float, 1, 5>::Zero();
+        h(0, 0) = (expectedRange(at.x + step, at.y, at.theta, mount) - expectedRange(at.x - step, at.y, at.theta, mount)) / (2 * step);
+        h(0, 1) = (expectedRange(at.x, at.y + step, at.theta, mount) - expectedRange(at.x, at.y - step, at.theta, mount)) / (2 * step);
+        h(0, 2) = (expectedRange(at.x, at.y, at.theta + step, mount) - expectedRange(at.x, at.y, at.theta - step, mount)) / (2 * step);
+        return update<1>(Eigen::Matrix<float, 1, 1>(range - expected), h, Eigen::Matrix<float, 1, 1>(noise.range * noise.range), true);
+    }
+
+    // Field-frame velocity, in/s and rad/s
+    float vx() const { return state(3) * std::sin(state(2)); }
+    float vy() const { return state(3) * std::cos(state(2)); }
+    float omega() const { return state(4); }
+private:
+    static float expectedRange(float x, float y, float theta, const SensorMount& mount) {
+        float px, py, heading;
+        sensorRay(x, y, theta, mount, px, py, heading);
+        return wallRange(px, py, heading);
+    }
+
+    // Standard EKF correction. A gated one is skipped when the innovation is too unlikely;
+    // the wheels and gyro are never gated, they are what keeps the filter moving at all
+    template <int M>
+    bool update(const Eigen::Matrix<float, M, 1>& residual, const Eigen::Matrix<float, M, 5>& h,
+                const Eigen::Matrix<float, M, M>& r, bool gated = false) {
+        Eigen::Matrix<float, M, M> innovation = h * covariance * h.transpose() + r;
+        Eigen::Matrix<float, M, M> inverse = innovation.inverse();
+        if (gated && residual.dot(inverse * residual) > noise.gate * M) return false;
+        Eigen::Matrix<float, 5, M> gain = covariance * h.transpose() * inverse;
+        state += gain * residual;
+        covariance = (Covariance::Identity() - gain * h) * covariance;
+        covariance = (covariance + covariance.transpose()) / 2;
+        return true;
+    }
+
+    FilterNoise noise;
+    State state;
+    Covariance covariance;
+};
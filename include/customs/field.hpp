@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cmath>
+
+// Field geometry for sensors that range off it. Inches from the field centre, compass
+// headings in radians (0 along +y, clockwise positive), the frame LemLib's pose uses.
+
+// The walls' inside faces, 12 ft of field less the perimeter's thickness
+constexpr float FIELD_HALF = 70.2f;
+// Each wall stake stands 2 in off the middle of its wall and this far either side of it
+constexpr float STAKE_HALF_WIDTH = 2;
+
+// A distance sensor on the robot: where it sits relative to the tracking centre and which
+// way it faces relative to the robot's heading
+struct SensorMount {
+    float right, forward; // inches
+    float angle; // radians, 0 facing forwards, clockwise positive
+};
+
+// Where a mounted sensor is and which way it points for a robot pose
+inline void sensorRay(float x, float y, float theta, const SensorMount& mount, float& px, float& py, float& heading) {
+    float s = std::sin(theta), c = std::cos(theta);
+    px = x + mount.right * c + mount.forward * s;
+    py = y - mount.right * s + mount.forward * c;
+    heading = theta + mount.angle;
+}
+
+// Range along a ray from (px, py) on the compass heading to the first wall it meets, and
+// which wall: 0 +x, 1 -x, 2 +y, 3 -y
+inline float wallRange(float px, float py, float heading, int* wall = nullptr) {
+    float dx = std::sin(heading), dy = std::cos(heading);
+    float tx = dx > 1e-6f ? (FIELD_HALF - px) / dx : dx < -1e-6f ? (-FIELD_HALF - px) / dx : INFINITY;
+    float ty = dy > 1e-6f ? (FIELD_HALF - py) / dy : dy < -1e-6f ? (-FIELD_HALF - py) / dy : INFINITY;
+    if (wall != nullptr) *wall = tx < ty ? (dx > 0 ? 0 : 1) : (dy > 0 ? 2 : 3);
+    return std::fmin(tx, ty);
+}
+
+// Whether a beam that met `wall` after `range` landed on the wall stake in its middle, which
+// stands proud of the wall and reads short
+inline bool onWallStake(float px, float py, float heading, float range, int wall) {
+    float along = wall <= 1 ? py + range * std::cos(heading) : px + range * std::sin(heading);
+    return std::fabs(along) < STAKE_HALF_WIDTH + 1;
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include "customs/path.hpp"
+#include "customs/trajectory.hpp"
+#include "lemlib/pose.hpp"
+
+// Feedforward from target forward velocity (in/s) and acceleration (in/s^2) to tank() power
+// out of 127, plus proportional correction on the measured forward speed
+struct FollowConstants {
+    PathLimits limits;
+    float kV, kA, kS, kP;
+};
+
+extern FollowConstants followConstants;
+
+// Pure pursuit over a CompiledPath. Each tick only searches a window around the robot, so
+// the cost no longer grows with path length. A path run through profileVelocity is tracked
+// with feedforward, otherwise the speed column is sent as is. Blocks until the end of the
+// path or timeout.
+void followPath(const CompiledPath& path, float lookahead, int timeout, bool forwards = true);
+
+// RAMSETE gains for followTrajectory. b is per square inch, 2 per square metre from the
+// riderlib sweep
+struct TrajectoryParams {
+    float b = 0.0013f;
+    float zeta = 0.7f;
+};
+
+// Point i of a compiled trajectory as a chassis pose, inches and compass degrees
+lemlib::Pose trajectoryPose(const TrajectoryView& trajectory, uint32_t i);
+
+// Plays a trajectory compiled by `riderlib --compile`, one point per dt by the clock.
+// RAMSETE pulls the chassis pose back onto each point, feedforward on followConstants and
+// turnConstants drives it, and each point's voltage cap scales the output. Start the chassis
+// on trajectoryPose(trajectory, 0). Blocks until the last point or timeout.
+void followTrajectory(const TrajectoryView& trajectory, int timeout, TrajectoryParams params = {});
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include "pros/distance.hpp"
+#include "pros/rtos.hpp"
+#include "customs/mcl.hpp"
+#include "lemlib/chassis/chassis.hpp"
+
+// Monte Carlo localization in its own task, a second opinion beside chassis.getPose().
+// Particles move by the timed odometry's dead-reckoned motion, which pose resets do not
+// count towards, and are scored on distance sensor ranges against the whole field map,
+// goals and ladder included, so a beam that lands on the ladder counts instead of being
+// thrown away as it is by the wall fixes.
+class ParticleLocalizer {
+public:
+    static constexpr size_t CAPACITY = 4;
+
+    ParticleLocalizer(lemlib::Chassis& chassis, int particles = 1000, uint32_t period = 50)
+        : chassis(chassis), map(FieldMap::highStakes()), filter(map, particles), period(period) {}
+
+    bool addSensor(pros::Distance& sensor, SensorMount mount);
+
+    // Scatters the particles around a pose, starting the task on first call
+    void start(PlanarPose pose, float spread = 2, float headingSpread = 0.05f);
+
+    PlanarPose pose();
+    float spread();
+    uint32_t worstUs(); // longest step so far, for checking the period fits
+
+    // Pull the chassis and timed odometry x and y `gain` of the way to the estimate each step
+    // the particles agree to within `trust` inches, 0 to leave them alone
+    float gain = 0;
+    float trust = 1.5f;
+private:
+    void step();
+
+    struct Sensor {
+        pros::Distance* sensor;
+        SensorMount mount;
+    };
+
+    lemlib::Chassis& chassis;
+    FieldMap map;
+    ParticleFilter filter;
+    uint32_t period; // ms
+    std::array<Sensor, CAPACITY> sensors;
+    size_t count = 0;
+    PlanarPose last = {0, 0, 0}, estimate = {0, 0, 0};
+    float agreement = INFINITY;
+    uint32_t worst = 0;
+    pros::Mutex mutex;
+    pros::Task* task = nullptr;
+};
+
+extern ParticleLocalizer localizer;
@@ -0,0 +1,220 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include "Eigen/Dense"
+#include "customs/field.hpp"
+#include "customs/timesync.hpp"
+
+// Monte Carlo localization against a map of what a distance sensor can see on the High
+// Stakes field. Particles are kept as structure-of-arrays in Eigen arrays, so moving and
+// scoring them runs in SIMD packets (SSE on the host, NEON on the brain), and the ray cast
+// takes eight particles at a time through every segment instead of one. All arrays are
+// sized once at construction.
+
+// Line segments at sensor height, start point and direction to the end, SoA
+struct FieldMap {
+    Eigen::ArrayXf ax, ay, ex, ey;
+
+    int size() const { return int(ax.size()); }
+
+    void add(float x0, float y0, float x1, float y1) {
+        int n = size();
+        for (Eigen::ArrayXf* column : {&ax, &ay, &ex, &ey}) column->conservativeResize(n + 1);
+        ax[n] = x0;
+        ay[n] = y0;
+        ex[n] = x1 - x0;
+        ey[n] = y1 - y0;
+    }
+
+    // The perimeter, the ladder's low rungs between its corner posts, and the faces of the
+    // four wall stakes standing 2 in off the middle of each wall
+    static FieldMap highStakes() {
+        FieldMap map;
+        const float h = FIELD_HALF, post = 24, stake = 2, width = 2;
+        map.add(-h, -h, h, -h);
+        map.add(h, -h, h, h);
+        map.add(h, h, -h, h);
+        map.add(-h, h, -h, -h);
+        map.add(post, 0, 0, post);
+        map.add(0, post, -post, 0);
+        map.add(-post, 0, 0, -post);
+        map.add(0, -post, post, 0);
+        map.add(h - stake, -width, h - stake, width);
+        map.add(-h + stake, -width, -h + stake, width);
+        map.add(-width, h - stake, width, h - stake);
+        map.add(-width, -h + stake, width, -h + stake);
+        return map;
+    }
+
+    // Range from each origin along its unit direction to the nearest segment, INFINITY if none.
+    // Rays go through in blocks of eight held in registers, every segment tested against the
+    // whole block before the next block is loaded. Solves o + t d = a + u e with cross
+    // products; a miss comes out as a NaN or an out of range u and fails the comparison
+    void castRays(const Eigen::ArrayXf& ox, const Eigen::ArrayXf& oy, const Eigen::ArrayXf& dx, const Eigen::ArrayXf& dy,
+                  Eigen::ArrayXf& range) const {
+        using Block = Eigen::Array<float, 8, 1>;
+        int n = int(ox.size()), blocks = n - n % 8;
+        for (int i = 0; i < blocks; i += 8) {
+            Block x = ox.segment<8>(i), y = oy.segment<8>(i), u = dx.segment<8>(i), v = dy.segment<8>(i);
+            Block best = Block::Constant(INFINITY);
+            for (int s = 0; s < size(); ++s) {
+                // t and the position along the segment share the denominator, divide once
+                Block wx = ax[s] - x, wy = ay[s] - y;
+                Block inverse = (u * ey[s] - v * ex[s]).inverse();
+                Block t = (wx * ey[s] - wy * ex[s]) * inverse, along = (wx * v - wy * u) * inverse;
+                best = (t > 0 && along >= 0 && along <= 1 && t < best).select(t, best);
+            }
+            range.segment<8>(i) = best;
+        }
+        for (int i = blocks; i < n; ++i) range[i] = castRay(ox[i], oy[i], dx[i], dy[i]);
+    }
+
+    // One ray at a time against every segment, the reference castRays is measured against
+    float castRay(float ox, float oy, float dx, float dy) const {
+        float best = INFINITY;
+        for (int s = 0; s < size(); ++s) {
+            float inverse = 1 / (dx * ey[s] - dy * ex[s]);
+            float wx = ax[s] - ox, wy = ay[s] - oy;
+            float t = (wx * ey[s] - wy * ex[s]) * inverse, u = (wx * dy - wy * dx) * inverse;
+            if (t > 0 && u >= 0 && u <= 1 && t < best) best = t;
+        }
+        return best;
+    }
+};
+
+struct ParticleNoise {
+    float translation = 0.05f; // inches of spread per inch driven
+    float rotation = 0.05f; // radians per radian turned
+    float drift = 0.02f; // inches and radians/10 added every step regardless
+    float range = 1.0f; // inches, distance sensor
+    float outlier = 0.1f; // share of readings caught by something not on the map
+    float maxRange = 78; // inches, longer readings are not scored
+};
+
+class ParticleFilter {
+public:
+    ParticleFilter(const FieldMap& map, int particles, ParticleNoise noise = {}, uint32_t seed = 1)
+        : map(map), noise(noise), n(particles), random(seed ? seed : 1) {
+        for (Eigen::ArrayXf* column : {&x, &y, &theta, &weight, &ox, &oy, &dx, &dy, &expected, &sine, &cosine, &cumulative,
+                                       &nextX, &nextY, &nextTheta})
+            column->resize(n);
+    }
+
+    int size() const { return n; }
+
+    // Particles spread normally around a known pose
+    void reset(PlanarPose pose, float spread, float headingSpread) {
+        for (int i = 0; i < n; ++i) {
+            x[i] = pose.x + spread * gaussian();
+            y[i] = pose.y + spread * gaussian();
+            theta[i] = pose.theta + headingSpread * gaussian();
+        }
+        weight.setConstant(1.0f / n);
+    }
+
+    // Moves every particle by the robot's own motion since the last step, forward and
+    // sideways in the robot's frame, with noise in proportion to it
+    void predict(float forward, float sideways, float dTheta) {
+        float distance = std::hypot(forward, sideways);
+        float translation = noise.translation * distance + noise.drift;
+        float rotation = noise.rotation * std::fabs(dTheta) + noise.drift / 10;
+        // draw the noise first so the motion itself runs as whole-array packets
+        for (int i = 0; i < n; ++i) {
+            ox[i] = gaussian();
+            oy[i] = gaussian();
+            dx[i] = gaussian();
+        }
+        dy = theta + dTheta / 2;
+        sine = dy.sin();
+        cosine = dy.cos();
+        ox = forward + translation * ox;
+        oy = sideways + translation * oy;
+        x += ox * sine + oy * cosine;
+        y += ox * cosine - oy * sine;
+        theta += dTheta + rotation * dx;
+    }
+
+    // Scores every particle on one sensor's reading: a normal around the range the map
+    // predicts from that particle, plus a floor for readings off something unmapped
+    void update(const SensorMount& mount, float range) {
+        if (!(range < noise.maxRange)) return;
+        // sensor origin and direction for every particle as in sensorRay, then one cast
+        sine = theta.sin();
+        cosine = theta.cos();
+        float s = std::sin(mount.angle), c = std::cos(mount.angle);
+        ox = x + mount.right * cosine + mount.forward * sine;
+        oy = y - mount.right * sine + mount.forward * cosine;
+        dx = sine * c + cosine * s;
+        dy = cosine * c - sine * s;
+        map.castRays(ox, oy, dx, dy, expected);
+        float hit = (1 - noise.outlier), floor = noise.outlier / noise.maxRange;
+        float scale = -0.5f / (noise.range * noise.range);
+        expected = ((expected - range).square() * scale).exp() * (hit / (noise.range * 2.5066f)) + floor;
+        // particles that wandered off the field score as outliers only
+        weight *= (x.abs() < FIELD_HALF && y.abs() < FIELD_HALF).select(expected, floor);
+        float total = weight.sum();
+        if (total > 0) weight /= total;
+        else weight.setConstant(1.0f / n);
+        if (1 / weight.square().sum() < n / 2.0f) resample();
+    }
+
+    PlanarPose estimate() const {
+        float s = (weight * theta.sin()).sum(), c = (weight * theta.cos()).sum();
+        return {(weight * x).sum(), (weight * y).sum(), std::atan2(s, c)};
+    }
+
+    // Weighted standard deviation of position, inches; small once the particles agree
+    float spread() const {
+        PlanarPose mean = estimate();
+        return std::sqrt((weight * ((x - mean.x).square() + (y - mean.y).square())).sum());
+    }
+private:
+    // Systematic resampling, one random offset for evenly spaced picks along the cumulative weight
+    void resample() {
+        float sum = 0;
+        for (int i = 0; i < n; ++i) cumulative[i] = sum += weight[i];
+        float step = sum / n, pick = uniform() * step;
+        int j = 0;
+        for (int i = 0; i < n; ++i, pick += step) {
+            while (j < n - 1 && cumulative[j] < pick) ++j;
+            nextX[i] = x[j];
+            nextY[i] = y[j];
+            nextTheta[i] = theta[j];
+        }
+        x.swap(nextX);
+        y.swap(nextY);
+        theta.swap(nextTheta);
+        weight.setConstant(1.0f / n);
+    }
+
+    // xorshift32, cheap and allocation free
+    float uniform() {
+        random ^= random << 13;
+        random ^= random >> 17;
+        random ^= random << 5;
+        return (random >> 8) * (1.0f / 16777216.0f);
+    }
+
+    // Box-Muller, keeping the second of each pair for the next call
+    float gaussian() {
+        if (spare) {
+            spare = false;
+            return second;
+        }
+        float radius = std::sqrt(-2 * std::log(uniform() + 1e-7f)), angle = 2 * float(M_PI) * uniform();
+        second = radius * std::sin(angle);
+        spare = true;
+        return radius * std::cos(angle);
+    }
+
+    const FieldMap& map;
+    ParticleNoise noise;
+    int n;
+    uint32_t random;
+    float second = 0;
+    bool spare = false;
+    Eigen::ArrayXf x, y, theta, weight;
+    Eigen::ArrayXf ox, oy, dx, dy, expected, sine, cosine; // motion and ray cast scratch
+    Eigen::ArrayXf cumulative, nextX, nextY, nextTheta; // resampling scratch
+};
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <functional>
+#include <variant>
+#include "pros/rtos.hpp"
+#include "customs/chaining.hpp"
+#include "customs/settle.hpp"
+#include "customs/timeouts.hpp"
+#include "lemlib/chassis/chassis.hpp"
+
+// Bounded queue of chassis commands run by a dedicated task. Autons push a whole routine
+// up front and the queue task replays it with the same semantics as calling the chassis
+// directly, but because the next command is already known while the current one runs a
+// motion can hand off to its successor at speed instead of settling first.
+
+struct QueuedCommand {
+    enum class Type { MOVE_TO_POINT, MOVE_TO_POSE, TURN_TO_HEADING, TURN_TO_POINT, SWING_TO_HEADING, ACTION, WAIT_UNTIL, WAIT_UNTIL_DONE, DELAY };
+    using Params = std::variant<lemlib::MoveToPointParams, lemlib::MoveToPoseParams, lemlib::TurnToHeadingParams,
+                                lemlib::TurnToPointParams, lemlib::SwingToHeadingParams>;
+
+    Type type = Type::ACTION;
+    float x = 0, y = 0, theta = 0; // Target, or distance for WAIT_UNTIL
+    int timeout = 0; // Motion timeout, or milliseconds for DELAY
+    lemlib::DriveSide side = lemlib::DriveSide::LEFT;
+    Params params;
+    float handoffSpeed = 0; // Speed (out of 127) carried into the next motion, 0 to settle
+    static constexpr float AUTO_HANDOFF = -1; // handoffSpeed planned from the next move's geometry
+    std::function<void()> action;
+
+    bool isMotion() const { return type <= Type::SWING_TO_HEADING; }
+    bool isTurn() const { return type >= Type::TURN_TO_HEADING && type <= Type::SWING_TO_HEADING; }
+};
+
+class MotionQueue {
+public:
+    static constexpr size_t CAPACITY = 32;
+
+    explicit MotionQueue(lemlib::Chassis& chassis) : chassis(chassis) {}
+
+    // Same arguments as the chassis call plus the speed to hold through the handoff
+    void moveToPoint(float x, float y, int timeout, lemlib::MoveToPointParams params = {}, float handoffSpeed = 0);
+    void moveToPose(float x, float y, float theta, int timeout, lemlib::MoveToPoseParams params = {}, float handoffSpeed = 0);
+    void turnToHeading(float theta, int timeout, lemlib::TurnToHeadingParams params = {}, float handoffSpeed = 0);
+    void turnToPoint(float x, float y, int timeout, lemlib::TurnToPointParams params = {}, float handoffSpeed = 0);
+    void swingToHeading(float theta, lemlib::DriveSide side, int timeout, lemlib::SwingToHeadingParams params = {}, float handoffSpeed = 0);
+
+    // Runs once the motion queued before it has started, like code placed after a chassis call
+    void then(std::function<void()> action);
+    // Arms a distance trigger on the motion queued before it without holding up the queue
+    void onDistance(float dist, std::function<void()> action);
+    void waitUntil(float dist);
+    void waitUntilDone();
+    void delay(int ms);
+
+    // Blocks the caller until every queued command has run and the last motion has finished
+    void waitUntilEmpty();
+    // Drops pending commands and stops the running motion, which is not reported to timeouts
+    void clear();
+    bool idle();
+
+    // Print "motion <index> <timeout> <turn|move>" then "<ms> <error> <output>" every tick of each
+    // settle-watched motion, the trace format `riderlib --settle` replays
+    bool logSettle = false;
+    // Moves pushed while set without their own handoff speed carry momentum into a following
+    // move, at the speed and early exit range planHandoff gives for the corner between them
+    bool chaining = false;
+private:
+    float chained(float handoffSpeed) const;
+    void push(QueuedCommand command);
+    void blend(QueuedCommand& command, size_t index);
+    void execute(QueuedCommand& command);
+    void waitForMotion();
+    bool cleared();
+    void run();
+
+    lemlib::Chassis& chassis;
+    std::array<QueuedCommand, CAPACITY> buffer;
+    size_t head = 0;
+    size_t count = 0;
+    bool busy = false;
+    QueuedCommand current; // Last motion started, watched for settling unless it hands off
+    bool watching = false;
+    bool pending = false; // current has not been waited out and reported to timeouts yet
+    uint32_t currentStart = 0;
+    int motionIndex = 0;
+    uint32_t generation = 0; // Bumped by clear()
+    uint32_t taken = 0; // Generation when the command being executed left the queue
+    pros::Mutex mutex;
+    pros::Task* task = nullptr;
+};
+
+extern SettleParams lateralSettle;
+extern SettleParams angularSettle;
+extern MotionQueue motions;
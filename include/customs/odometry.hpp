@@ -0,0 +1,121 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include "pros/distance.hpp"
+#include "pros/gps.hpp"
+#include "pros/imu.hpp"
+#include "pros/motor_group.hpp"
+#include "pros/rotation.hpp"
+#include "pros/rtos.hpp"
+#include "customs/ekf.hpp"
+#include "customs/timesync.hpp"
+
+// Odometry in its own high-priority task. The drive motors stamp their encoder counts on
+// the device, the rotation sensors and IMU are stamped when a new value first shows up, and
+// every tick all of them are interpolated to the latest instant every sensor has reached
+// before the arc is integrated. The drive motors stand in for the vertical wheel if it
+// stops reporting.
+//
+// The same aligned readings feed a PoseFilter as wheel and gyro rates, along with a GPS and
+// distance sensors when they are added, so estimate() is corrected where pose() only drifts.
+// Each estimate also goes into a lock-free history, so a sensor with a known latency is
+// fused against where the robot was when it took the reading, and any task can ask where
+// the robot was at an earlier instant.
+
+// Reversal of each motor in a drive motor group, +1 or -1, read when the task starts
+struct MotorSigns {
+    std::array<float, 8> sign {};
+    size_t count = 0;
+};
+
+struct OdometryGeometry {
+    float verticalDiameter, verticalOffset; // inches
+    float horizontalDiameter, horizontalOffset;
+    float driveDiameter, driveRpm; // drive wheel and its rpm at full speed
+};
+
+// Staleness of each sensor's newest sample when a tick integrated, and the task's period jitter
+struct OdometryTiming {
+    JitterStats jitter;
+    StalenessStats vertical, horizontal, imu, drive;
+    uint32_t fallbacks = 0; // ticks the drive motors stood in for the vertical wheel
+    uint32_t ranges = 0, rangesRejected = 0; // distance readings fused and gated out
+    uint32_t filterMaxUs = 0; // longest filter predict and update of a tick
+};
+
+class TimedOdometry {
+public:
+    TimedOdometry(pros::Rotation& vertical, pros::Rotation& horizontal, pros::Imu& imu, pros::MotorGroup& left,
+                  pros::MotorGroup& right, OdometryGeometry geometry, uint32_t period = 5)
+        : vertical(vertical), horizontal(horizontal), imu(imu), left(left), right(right), geometry(geometry),
+          period(period) {}
+
+    // Starts the task once the sensors are calibrated, from the chassis pose at the time
+    void start();
+    // Dead-reckoned pose, and the filter's estimate with every sensor fused
+    PlanarPose pose();
+    PlanarPose estimate();
+    // Dead reckoning from wherever the task started, which setPose never moves. Differences
+    // between two calls are only the robot's own motion
+    PlanarPose motion();
+    void setPose(PlanarPose pose);
+    // Nudges x and y without restarting anything: the filter keeps its velocity and
+    // covariance, and the history moves with it. For small corrections made often
+    void shift(float dx, float dy);
+    OdometryTiming timing();
+    // The estimate at a pros::micros() time within the last 0.6s, or just past the latest
+    // along its velocity; false if that is older than the history goes. Takes no lock
+    bool estimateAt(uint64_t time, PoseSample& sample) const { return history.at(time, sample); }
+
+    // Call before start(). Latency is how long before it shows up a reading was taken, ms
+    void useGps(pros::Gps& gps, float headingError = 0.05f, uint32_t latency = 0);
+    bool addRangeSensor(pros::Distance& sensor, SensorMount mount, uint32_t latency = 0);
+
+    // Write each estimate into the chassis so LemLib's motions run on it. Only once every
+    // pose is set through setRobotPose, a bare chassis.setPose never reaches this odometry
+    bool driveChassis = false;
+private:
+    struct RangeSensor {
+        pros::Distance* sensor;
+        SensorMount mount;
+        std::int32_t last;
+        uint32_t latency;
+    };
+
+    void sample(uint64_t now);
+    void update();
+    void fuse(uint64_t now, float dt, float forward, float sideways, float dTheta, float verticalOffset);
+    PlanarPose estimateBefore(uint64_t now, uint32_t latency) const;
+
+    pros::Rotation& vertical;
+    pros::Rotation& horizontal;
+    pros::Imu& imu;
+    pros::MotorGroup& left;
+    pros::MotorGroup& right;
+    MotorSigns leftSigns, rightSigns;
+    OdometryGeometry geometry;
+    uint32_t period; // ms
+
+    TimedSignal<> verticalSignal, horizontalSignal, headingSignal, driveSignal;
+    uint64_t aligned = 0; // instant the pose was last integrated to, us
+    float lastVertical = 0, lastHorizontal = 0, lastHeading = 0, lastDrive = 0;
+    PlanarPose current;
+    PlanarPose travelled; // motion(), never reset
+    PoseFilter filter;
+    PoseHistory<> history; // 128 estimates, 0.64s at 5ms
+    pros::Gps* gps = nullptr;
+    float gpsHeadingError = 0;
+    uint32_t gpsLatency = 0;
+    pros::gps_status_s_t lastGps {};
+    std::array<RangeSensor, 4> rangeSensors;
+    size_t rangeCount = 0;
+    OdometryTiming stats;
+    pros::Mutex mutex;
+    pros::Task* task = nullptr;
+};
+
+extern TimedOdometry odometry;
+
+// chassis.setPose for both the chassis and the timed odometry, compass degrees
+void setRobotPose(float x, float y, float theta);
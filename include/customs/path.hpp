@@ -0,0 +1,200 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include "lemlib/asset.hpp"
+
+// Path asset parsed once into flat arrays with a cumulative-distance index, so the follower
+// only ever searches a short window of the path around the robot. Positions are inches,
+// speed is a fraction of full drivetrain speed.
+struct CompiledPath {
+    std::vector<float> x, y, speed;
+    std::vector<float> distance; // Arc length from the first point
+    std::vector<float> curvature; // 1/inches, positive turning left
+    std::vector<float> velocity, acceleration; // in/s and in/s^2 once profiled, empty otherwise
+
+    size_t size() const { return x.size(); }
+    float length() const { return distance.empty() ? 0 : distance.back(); }
+
+    void push(float px, float py, float s, float k = 0) {
+        float d = x.empty() ? 0 : distance.back() + std::hypot(px - x.back(), py - y.back());
+        x.push_back(px);
+        y.push_back(py);
+        speed.push_back(s);
+        distance.push_back(d);
+        curvature.push_back(k);
+    }
+};
+
+// Curvature of a sampled path from the circle through each point and its neighbours
+inline void estimateCurvature(CompiledPath& path) {
+    for (size_t i = 1; i + 1 < path.size(); i++) {
+        float ax = path.x[i] - path.x[i - 1], ay = path.y[i] - path.y[i - 1];
+        float bx = path.x[i + 1] - path.x[i], by = path.y[i + 1] - path.y[i];
+        float cx = path.x[i + 1] - path.x[i - 1], cy = path.y[i + 1] - path.y[i - 1];
+        float sides = std::hypot(ax, ay) * std::hypot(bx, by) * std::hypot(cx, cy);
+        path.curvature[i] = sides == 0 ? 0 : 2 * (ax * by - ay * bx) / sides;
+    }
+}
+
+// Position just past the first `key` in [from, end), or nullptr
+inline const char* jsonFind(const char* from, const char* end, const char* key) {
+    size_t length = std::strlen(key);
+    for (const char* p = from; p + length <= end; p++) {
+        p = static_cast<const char*>(std::memchr(p, key[0], end - p));
+        if (p == nullptr || p + length > end) break;
+        if (std::memcmp(p, key, length) == 0) return p + length;
+    }
+    return nullptr;
+}
+
+// Reads both path formats jerryio exports: "LemLib v0.4.x" (x, y, speed out of 127 until
+// endData) and "path.jerryio" (#PATH-POINTS-START, then x,y,rpm[,heading] in the units named
+// in the trailing JSON). driveRpm converts rpm speeds to a fraction of full speed.
+inline CompiledPath parsePath(const asset& file, float driveRpm) {
+    CompiledPath path;
+    const char* text = reinterpret_cast<const char*>(file.buf);
+    const char* end = text + file.size;
+
+    bool jerryio = file.size >= 18 && std::strncmp(text, "#PATH-POINTS-START", 18) == 0;
+    float scale = 1, speedScale = 1.0f / 127;
+    if (jerryio) {
+        speedScale = 1 / driveRpm;
+        // the unit sits in the JSON format string, e.g. "path.jerryio v0.1.x (cm, rpm)"
+        if (jsonFind(text, end, "(cm,") != nullptr) scale = 1 / 2.54f;
+        else if (jsonFind(text, end, "(mm,") != nullptr) scale = 1 / 25.4f;
+    }
+
+    const char* line = text;
+    while (line < end) {
+        const char* next = static_cast<const char*>(std::memchr(line, '\n', end - line));
+        if (next == nullptr) next = end;
+
+        // copy out so strtof never runs past the end of an asset that is not null terminated
+        char buf[64];
+        size_t length = std::min(size_t(next - line), sizeof(buf) - 1);
+        std::memcpy(buf, line, length);
+        buf[length] = '\0';
+        line = next + 1;
+
+        if (jerryio && buf[0] == '#') {
+            if (path.size() == 0) continue; // the header line
+            break; // the JSON trailer
+        }
+        if (std::strncmp(buf, "endData", 7) == 0) break;
+
+        char* cursor = buf;
+        float values[3];
+        int count = 0;
+        for (; count < 3; count++) {
+            char* after;
+            values[count] = std::strtof(cursor, &after);
+            if (after == cursor) break;
+            cursor = after;
+            while (*cursor == ',' || *cursor == ' ') cursor++;
+        }
+        if (count < 3) continue;
+        path.push(values[0] * scale, values[1] * scale, values[2] * speedScale);
+    }
+    estimateCurvature(path);
+    return path;
+}
+
+struct PathLimits {
+    float maxVelocity; // in/s
+    float maxAcceleration; // in/s^2, also used for braking
+    float maxLateralAcceleration; // in/s^2 through corners before the wheels slip
+};
+
+// Time-optimal velocity along the path. Each point is capped by the speed column (relative
+// to its largest value, so a constant column means full speed), by lateral acceleration on its curvature and by the outer wheel
+// reaching maxVelocity, then a forward pass limits acceleration out of the start and a
+// backward pass braking into the end and into every corner. Returns the traverse time.
+inline float profileVelocity(CompiledPath& path, const PathLimits& limits, float trackWidth) {
+    size_t n = path.size();
+    path.velocity.assign(n, 0);
+    path.acceleration.assign(n, 0);
+    if (n < 2) return 0;
+
+    float top = *std::max_element(path.speed.begin(), path.speed.end());
+    for (size_t i = 0; i < n; i++) {
+        float k = std::fabs(path.curvature[i]);
+        float v = top > 0 ? path.speed[i] / top * limits.maxVelocity : limits.maxVelocity;
+        if (k > 0) v = std::fmin(v, std::sqrt(limits.maxLateralAcceleration / k));
+        path.velocity[i] = std::fmin(v, limits.maxVelocity / (1 + k * trackWidth / 2));
+    }
+    path.velocity[0] = 0;
+    path.velocity[n - 1] = 0;
+    for (size_t i = 1; i < n; i++) {
+        float ds = path.distance[i] - path.distance[i - 1];
+        path.velocity[i] = std::fmin(path.velocity[i], std::sqrt(path.velocity[i - 1] * path.velocity[i - 1] + 2 * limits.maxAcceleration * ds));
+    }
+    for (size_t i = n - 1; i-- > 0;) {
+        float ds = path.distance[i + 1] - path.distance[i];
+        path.velocity[i] = std::fmin(path.velocity[i], std::sqrt(path.velocity[i + 1] * path.velocity[i + 1] + 2 * limits.maxAcceleration * ds));
+    }
+
+    float time = 0;
+    for (size_t i = 0; i + 1 < n; i++) {
+        float ds = path.distance[i + 1] - path.distance[i];
+        float v0 = path.velocity[i], v1 = path.velocity[i + 1];
+        if (ds > 0) path.acceleration[i] = (v1 * v1 - v0 * v0) / (2 * ds);
+        if (v0 + v1 > 0) time += 2 * ds / (v0 + v1);
+    }
+    return time;
+}
+
+// Point at a fractional index, i.e. segment i plus a fraction along it
+inline void pathPoint(const CompiledPath& path, float index, float& px, float& py) {
+    size_t i = std::min(size_t(index), path.size() - 1);
+    float t = index - i;
+    if (i + 1 >= path.size()) t = 0;
+    px = path.x[i] + t * (path.x[i + (t > 0)] - path.x[i]);
+    py = path.y[i] + t * (path.y[i + (t > 0)] - path.y[i]);
+}
+
+// Closest point at or after `from`, scanning only `window` inches of path ahead of it.
+// The robot only moves forward along the path, so the previous answer is the start.
+inline size_t closestPoint(const CompiledPath& path, float px, float py, size_t from, float window) {
+    size_t best = from;
+    float bestDistance = INFINITY;
+    float limit = path.distance[from] + window;
+    for (size_t i = from; i < path.size() && path.distance[i] <= limit; i++) {
+        float dx = path.x[i] - px, dy = path.y[i] - py;
+        float d = dx * dx + dy * dy;
+        if (d < bestDistance) {
+            bestDistance = d;
+            best = i;
+        }
+    }
+    return best;
+}
+
+// Furthest intersection of the lookahead circle with the path, searched from the previous
+// lookahead and bounded to twice the radius of arc length past the closest point. Returns
+// a fractional index that never moves backwards.
+inline float lookaheadIndex(const CompiledPath& path, float px, float py, float radius, size_t closest, float from) {
+    size_t last = path.size() - 1;
+    float endDx = path.x[last] - px, endDy = path.y[last] - py;
+    if (endDx * endDx + endDy * endDy <= radius * radius) return last;
+
+    float best = std::fmax(from, closest);
+    float limit = path.distance[closest] + 2 * radius;
+    for (size_t i = size_t(best); i < last && path.distance[i] <= limit; i++) {
+        float dx = path.x[i + 1] - path.x[i], dy = path.y[i + 1] - path.y[i];
+        float fx = path.x[i] - px, fy = path.y[i] - py;
+        float a = dx * dx + dy * dy;
+        if (a == 0) continue;
+        float b = 2 * (fx * dx + fy * dy);
+        float c = fx * fx + fy * fy - radius * radius;
+        float discriminant = b * b - 4 * a * c;
+        if (discriminant < 0) continue;
+        float t = (-b + std::sqrt(discriminant)) / (2 * a);
+        if (t >= 0 && t <= 1 && i + t > best) best = i + t;
+    }
+    return best;
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cmath>
+
+// Time-optimal point-to-point motion profile over a distance, in whatever units the caller
+// uses (degrees for turns). TRAPEZOID ramps velocity linearly at maxAcceleration; S_CURVE
+// ramps with a smoothstep so acceleration starts and ends at zero, peaking at maxAcceleration,
+// which stretches each ramp by half but avoids the jerk that makes a turn overshoot.
+enum class ProfileShape { TRAPEZOID, S_CURVE };
+
+class MotionProfile1D {
+public:
+    MotionProfile1D(float distance, float maxVelocity, float maxAcceleration, ProfileShape shape = ProfileShape::TRAPEZOID)
+        : distance(std::fabs(distance)), shape(shape) {
+        float k = shape == ProfileShape::S_CURVE ? 1.5f : 1.0f; // ramp time per unit velocity, over 1/maxAcceleration
+        peak = std::fmin(maxVelocity, std::sqrt(this->distance * maxAcceleration / k));
+        ramp = peak > 0 ? k * peak / maxAcceleration : 0;
+        total = peak > 0 ? 2 * ramp + (this->distance - peak * ramp) / peak : 0;
+    }
+
+    float duration() const { return total; }
+    float peakVelocity() const { return peak; }
+
+    void sample(float t, float& position, float& velocity, float& acceleration) const {
+        if (t <= 0 || total == 0) {
+            position = velocity = acceleration = 0;
+        } else if (t >= total) {
+            position = distance;
+            velocity = acceleration = 0;
+        } else if (t < ramp) {
+            rampUp(t / ramp, position, velocity, acceleration);
+        } else if (t <= total - ramp) {
+            position = peak * ramp / 2 + peak * (t - ramp);
+            velocity = peak;
+            acceleration = 0;
+        } else {
+            // braking mirrors the ramp up from the far end
+            rampUp((total - t) / ramp, position, velocity, acceleration);
+            position = distance - position;
+            acceleration = -acceleration;
+        }
+    }
+private:
+    void rampUp(float u, float& position, float& velocity, float& acceleration) const {
+        if (shape == ProfileShape::S_CURVE) {
+            velocity = peak * u * u * (3 - 2 * u);
+            position = peak * ramp * u * u * u * (1 - u / 2);
+            acceleration = peak / ramp * 6 * u * (1 - u);
+        } else {
+            velocity = peak * u;
+            position = peak * ramp * u * u / 2;
+            acceleration = peak / ramp;
+        }
+    }
+
+    float distance;
+    ProfileShape shape;
+    float peak, ramp, total;
+};
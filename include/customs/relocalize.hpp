@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cmath>
+#include "customs/field.hpp"
+#include "customs/timesync.hpp"
+
+// Pins x and y against the field walls from distance sensor ranges instead of ramming a
+// wall and setting a hand-measured pose. A reading only counts when the beam from the
+// current estimate lands on a wall close to square and within `tolerance` of the range it
+// measured, so a beam caught by a goal or a robot is ignored rather than trusted. A beam
+// onto the middle of a wall lands on its wall stake and reads short, so it is skipped too.
+
+struct WallFix {
+    int axis; // 0 x, 1 y
+    float value; // robot coordinate along that axis the reading implies
+};
+
+// cos of the steepest beam accepted, 30 degrees off the wall's normal
+constexpr float WALL_INCIDENCE = 0.866f;
+
+inline bool wallFix(const PlanarPose& pose, const SensorMount& mount, float range, WallFix& fix, float tolerance = 4) {
+    float px, py, heading;
+    sensorRay(pose.x, pose.y, pose.theta, mount, px, py, heading);
+    int wall;
+    float expected = wallRange(px, py, heading, &wall);
+    if (!std::isfinite(expected) || std::fabs(range - expected) > tolerance) return false;
+
+    if (onWallStake(px, py, heading, expected, wall)) return false;
+    float dx = std::sin(heading), dy = std::cos(heading);
+    if (wall <= 1) {
+        if (std::fabs(dx) < WALL_INCIDENCE) return false;
+        float sensorX = (wall == 0 ? FIELD_HALF : -FIELD_HALF) - range * dx;
+        fix = {0, pose.x + sensorX - px};
+    } else {
+        if (std::fabs(dy) < WALL_INCIDENCE) return false;
+        float sensorY = (wall == 2 ? FIELD_HALF : -FIELD_HALF) - range * dy;
+        fix = {1, pose.y + sensorY - py};
+    }
+    return true;
+}
+
+// Moves the pose onto the mean fix of each axis some reading pins, `gain` of the way for a
+// gradual correction while moving. Heading is left alone, the IMU holds it far better than
+// a couple of ranges can. Returns which axes moved, bit 0 x and bit 1 y
+inline int relocalize(PlanarPose& pose, const SensorMount* mounts, const float* ranges, int count, float gain = 1,
+                      float tolerance = 4) {
+    float sum[2] = {0, 0};
+    int hits[2] = {0, 0};
+    for (int i = 0; i < count; i++) {
+        WallFix fix;
+        if (!wallFix(pose, mounts[i], ranges[i], fix, tolerance)) continue;
+        sum[fix.axis] += fix.value;
+        hits[fix.axis]++;
+    }
+    if (hits[0] > 0) pose.x += gain * (sum[0] / hits[0] - pose.x);
+    if (hits[1] > 0) pose.y += gain * (sum[1] / hits[1] - pose.y);
+    return (hits[0] > 0 ? 1 : 0) | (hits[1] > 0 ? 2 : 0);
+}
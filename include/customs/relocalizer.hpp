@@ -0,0 +1,47 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include "pros/distance.hpp"
+#include "pros/rtos.hpp"
+#include "customs/relocalize.hpp"
+#include "lemlib/chassis/chassis.hpp"
+
+// Wall relocalization for the chassis pose, on demand or continuously while driving.
+// Corrections go to both the chassis and the timed odometry so they stay on one pose.
+class Relocalizer {
+public:
+    static constexpr size_t CAPACITY = 4;
+
+    explicit Relocalizer(lemlib::Chassis& chassis) : chassis(chassis) {}
+
+    bool addSensor(pros::Distance& sensor, SensorMount mount);
+    // Whether any sensor is registered, so a routine can skip a wall reset it no longer needs
+    bool sensing() const { return count > 0; }
+
+    // Corrects x and y from one set of readings. An axis no reading pins falls back to the
+    // matching coordinate of `fallback`, the pose a wall reset would have set, so a routine
+    // keeps working on a robot without sensors facing that wall. The heading is always set
+    // to the fallback's
+    int relocalize();
+    int relocalize(lemlib::Pose fallback);
+
+    // Every 20ms pull x and y `gain` of the way to what the walls say, 0 to stop
+    void continuous(float gain = 0.1);
+private:
+    int correct(float gain);
+
+    struct Sensor {
+        pros::Distance* sensor;
+        SensorMount mount;
+    };
+
+    lemlib::Chassis& chassis;
+    std::array<Sensor, CAPACITY> sensors;
+    size_t count = 0;
+    float gain = 0;
+    pros::Mutex mutex;
+    pros::Task* task = nullptr;
+};
+
+extern Relocalizer relocalizer;
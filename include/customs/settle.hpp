@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+
+// Decides a motion is done from its error, how fast the error is changing and what the
+// controller is still commanding, instead of waiting out the timeout. Settled means inside
+// errorRange, barely moving and barely pushing for `time` ms. Stalled means stopped inside
+// the wider stallRange for `stallTime` ms, e.g. held short by friction or a field element,
+// where waiting any longer will not get the error down.
+struct SettleParams {
+    float errorRange; // inches or degrees
+    float velocityRange; // error change per second
+    float outputRange; // controller output out of 127
+    uint32_t time; // ms
+    float stallRange;
+    uint32_t stallTime; // ms
+};
+
+class SettleDetector {
+public:
+    explicit SettleDetector(SettleParams params) : params(params) {}
+
+    void reset() {
+        first = true;
+        done = false;
+        inside = stalled = 0;
+    }
+
+    // dt is the ms since the previous update
+    bool update(float error, float output, uint32_t dt) {
+        if (done) return true;
+        float velocity = first || dt == 0 ? INFINITY : (error - previous) * 1000 / dt;
+        previous = error;
+        first = false;
+
+        error = std::fabs(error);
+        bool still = std::fabs(velocity) < params.velocityRange;
+        inside = error < params.errorRange && still && std::fabs(output) < params.outputRange ? inside + dt : 0;
+        stalled = error < params.stallRange && still ? stalled + dt : 0;
+        done = inside >= params.time || stalled >= params.stallTime;
+        return done;
+    }
+
+    bool settled() const { return done; }
+private:
+    SettleParams params;
+    float previous = 0;
+    bool first = true;
+    bool done = false;
+    uint32_t inside = 0, stalled = 0;
+};
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+// Learns how long each motion of a routine actually takes, so timeouts padded for the worst
+// case can be tightened to what the robot needs. The motion queue reports every motion it
+// runs by its position in the routine; the history lives on the SD card at
+// /usd/timeouts_<routine>.csv, one "timeout,runs,longest" line per motion.
+//
+// A motion only counts once it has ended on its own (settled or exited early) for minRuns
+// runs in a row. One run that hits its timeout, tightened or not, clears its history so the
+// routine's own timeout is used again until it has proven itself.
+enum class TimeoutMode {
+    OFF, // record nothing
+    PROPOSE, // record, run the routine's timeouts and log the tightened ones at save()
+    APPLY // record and run the tightened timeouts
+};
+
+struct MotionRecord {
+    int timeout = 0; // ms, what the routine asks for
+    int runs = 0; // runs in a row that ended before the timeout
+    int longest = 0; // ms, longest of those runs
+};
+
+class TimeoutLearner {
+public:
+    TimeoutMode mode = TimeoutMode::PROPOSE;
+    float margin = 1.25; // learned timeout is longest * margin + padding
+    int padding = 50; // ms
+    int minRuns = 3;
+
+    // Starts a routine, loading its history. Motions outside begin/save are not recorded
+    void begin(const char* routine);
+    // Called as each motion starts, returns the timeout to run it with
+    int start(int timeout);
+    // Called as that motion ends, after `duration` ms
+    void finish(int duration, bool early);
+    // Writes the history back to the SD card and ends the routine
+    void save();
+
+    // What `timeout` would be tightened to for the record, or timeout if it has not earned it
+    int learned(const MotionRecord& record) const;
+private:
+    std::string routine;
+    std::vector<MotionRecord> records;
+    int index = -1;
+    bool active = false;
+};
+
+extern TimeoutLearner timeouts;
@@ -0,0 +1,241 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+// Building blocks for odometry that lines its sensors up in time. Each sensor's readings
+// are kept with the time they were taken, and every tick the wheels and heading are
+// interpolated to one common instant before integrating, instead of combining whatever
+// each device last reported at different moments.
+
+// The last few samples of one sensor, oldest first. Times are in microseconds
+template <size_t N = 8>
+class TimedSignal {
+public:
+    // Samples must arrive in time order, one at or before the latest is ignored
+    void push(uint64_t time, float value) {
+        if (count > 0 && time <= latestTime()) return;
+        times[(first + count) % N] = time;
+        values[(first + count) % N] = value;
+        if (count < N) count++;
+        else first = (first + 1) % N;
+    }
+
+    size_t size() const { return count; }
+    uint64_t latestTime() const { return times[(first + count - 1) % N]; }
+    float latest() const { return values[(first + count - 1) % N]; }
+
+    // Value at `time`, interpolated between the samples either side. Past the latest sample
+    // it extrapolates from the last two, before the oldest it holds the oldest
+    float at(uint64_t time) const {
+        if (count == 0) return 0;
+        if (count == 1) return latest();
+        size_t i = count - 1;
+        while (i > 1 && times[(first + i - 1) % N] >= time) i--;
+        uint64_t t0 = times[(first + i - 1) % N], t1 = times[(first + i) % N];
+        float v0 = values[(first + i - 1) % N], v1 = values[(first + i) % N];
+        if (time <= t0 && i == 1) return v0;
+        return v0 + (v1 - v0) * (double(time) - double(t0)) / double(t1 - t0);
+    }
+private:
+    std::array<uint64_t, N> times {};
+    std::array<float, N> values {};
+    size_t first = 0, count = 0;
+};
+
+// How old a sensor's newest sample was each tick
+struct StalenessStats {
+    uint32_t count = 0;
+    uint64_t sumUs = 0;
+    uint32_t maxUs = 0;
+
+    void add(uint64_t ageUs) {
+        count++;
+        sumUs += ageUs;
+        if (ageUs > maxUs) maxUs = ageUs;
+    }
+    float meanMs() const { return count == 0 ? 0 : sumUs / 1000.0f / count; }
+    float maxMs() const { return maxUs / 1000.0f; }
+};
+
+// How far the odometry task's wake-ups strayed from its period
+struct JitterStats {
+    uint32_t count = 0;
+    uint64_t sumUs = 0;
+    uint32_t maxUs = 0;
+
+    void add(int64_t periodUs, int64_t nominalUs) {
+        uint32_t jitter = uint32_t(std::llabs(periodUs - nominalUs));
+        count++;
+        sumUs += jitter;
+        if (jitter > maxUs) maxUs = jitter;
+    }
+    float meanMs() const { return count == 0 ? 0 : sumUs / 1000.0f / count; }
+    float maxMs() const { return maxUs / 1000.0f; }
+};
+
+// Field pose, inches and compass radians (0 along +y, clockwise positive)
+struct PlanarPose {
+    float x = 0, y = 0, theta = 0;
+};
+
+// Moves the pose by one tick of tracking wheel travel, assuming the robot drove a constant
+// arc over the tick. Offsets as in lemlib::TrackingWheel, negative left of and behind centre,
+// and like LemLib's odometry positive sideways travel is to the left
+inline void integrateArc(PlanarPose& pose, float forward, float sideways, float dTheta, float verticalOffset,
+                         float horizontalOffset) {
+    float localX = sideways, localY = forward;
+    if (dTheta != 0) {
+        float chord = 2 * std::sin(dTheta / 2);
+        localX = chord * (sideways / dTheta + horizontalOffset);
+        localY = chord * (forward / dTheta + verticalOffset);
+    }
+    float heading = pose.theta + dTheta / 2;
+    float s = std::sin(heading), c = std::cos(heading);
+    pose.x += localY * s - localX * c;
+    pose.y += localY * c + localX * s;
+    pose.theta += dTheta;
+}
+
+// Pose and field-frame velocity at an instant, us
+struct PoseSample {
+    uint64_t time = 0;
+    PlanarPose pose;
+    float vx = 0, vy = 0, omega = 0; // in/s and rad/s
+};
+
+// The last N poses one task has written, readable from any task without a lock, so a
+// reading that arrives late can be matched to where the robot was when it was taken. The
+// writer fills a slot and only then publishes it by bumping `written`; a reader copies the
+// slots it needs and checks afterwards that the writer has not come round to them again,
+// retrying if it has. Fences either side pair the slot copies with those checks, as in a
+// seqlock with `written` as the sequence. A shift is one offset added on the way out rather
+// than a rewrite of every slot, so a reader sees the whole history on one side of it. Meant
+// for one writer, with shift() called from the same task or under the same lock.
+template <size_t N = 128>
+class PoseHistory {
+public:
+    // Samples must arrive in time order, one at or before the latest is ignored
+    void push(const PoseSample& sample) {
+        uint32_t next = written.load(std::memory_order_relaxed);
+        if (next > start.load(std::memory_order_relaxed) && sample.time <= slots[(next - 1) % N].time) return;
+        // keeps the slot writes after the store that bumped `written` to next, so a reader
+        // that copies any part of the new sample also sees written has passed its old one
+        std::atomic_thread_fence(std::memory_order_release);
+        slots[next % N] = sample;
+        // stored without the shift so far, which comes back on when it is read
+        Offset o = offset();
+        slots[next % N].pose.x -= o.x;
+        slots[next % N].pose.y -= o.y;
+        written.store(next + 1, std::memory_order_release);
+    }
+
+    // Forgets everything written so far, for when the pose is reset and the old samples
+    // would interpolate across the jump
+    void clear() { start.store(written.load(std::memory_order_relaxed), std::memory_order_release); }
+
+    // Moves every sample held, and every one pushed after, by dx and dy inches, for a pose
+    // correction that keeps the history instead of dropping it
+    void shift(float dx, float dy) {
+        Offset o = offset();
+        o.x += dx;
+        o.y += dy;
+        uint64_t packed;
+        std::memcpy(&packed, &o, sizeof(packed));
+        shifted.store(packed, std::memory_order_release);
+    }
+
+    bool latest(PoseSample& sample) const {
+        for (int attempt = 0; attempt < 3; ++attempt) {
+            uint32_t end = written.load(std::memory_order_acquire);
+            if (end == start.load(std::memory_order_acquire)) return false;
+            sample = slots[(end - 1) % N];
+            if (intact(end - 1)) return unshift(sample);
+        }
+        return false;
+    }
+
+    // Sample at `time`, interpolated between the samples either side of it. Past the newest
+    // it extrapolates along the newest velocity as lemlib::estimatePose does; before the
+    // oldest still held, or with nothing written, it returns false
+    bool at(uint64_t time, PoseSample& sample) const {
+        for (int attempt = 0; attempt < 3; ++attempt) {
+            uint32_t end = written.load(std::memory_order_acquire);
+            // the slot after the newest may be mid-write, so one less than N is readable
+            uint32_t begin = std::max<uint32_t>(start.load(std::memory_order_acquire), end >= N ? end - N + 1 : 0);
+            if (end == begin) return false;
+            // first sample after `time`, by bisection over the held ones
+            uint32_t low = begin, high = end;
+            while (low < high) {
+                uint32_t middle = low + (high - low) / 2;
+                if (slots[middle % N].time <= time) low = middle + 1;
+                else high = middle;
+            }
+            // before the oldest, unless that was overwritten while bisecting
+            if (low == begin) {
+                if (intact(begin)) return false;
+                continue;
+            }
+            PoseSample before = slots[(low - 1) % N];
+            if (low == end) {
+                if (!intact(low - 1)) continue;
+                float dt = (double(time) - double(before.time)) / 1e6;
+                sample = before;
+                sample.time = time;
+                sample.pose.x += before.vx * dt;
+                sample.pose.y += before.vy * dt;
+                sample.pose.theta += before.omega * dt;
+                return unshift(sample);
+            }
+            PoseSample after = slots[low % N];
+            // a slot overwritten mid-bisection can send it to the wrong pair, so check the pair too
+            if (!intact(low - 1) || before.time > time || after.time <= time) continue;
+            float f = (double(time) - double(before.time)) / double(after.time - before.time);
+            sample.time = time;
+            sample.pose.x = before.pose.x + (after.pose.x - before.pose.x) * f;
+            sample.pose.y = before.pose.y + (after.pose.y - before.pose.y) * f;
+            sample.pose.theta = before.pose.theta + (after.pose.theta - before.pose.theta) * f;
+            sample.vx = before.vx + (after.vx - before.vx) * f;
+            sample.vy = before.vy + (after.vy - before.vy) * f;
+            sample.omega = before.omega + (after.omega - before.omega) * f;
+            return unshift(sample);
+        }
+        return false;
+    }
+private:
+    struct Offset {
+        float x, y;
+    };
+
+    Offset offset() const {
+        uint64_t packed = shifted.load(std::memory_order_relaxed);
+        Offset o;
+        std::memcpy(&o, &packed, sizeof(o));
+        return o;
+    }
+
+    // Puts the shift back on a sample read out. Loaded after intact()'s fence, so a sample
+    // pushed after a shift is never read with the offset from before it
+    bool unshift(PoseSample& sample) const {
+        Offset o = offset();
+        sample.pose.x += o.x;
+        sample.pose.y += o.y;
+        return true;
+    }
+
+    // Whether the slot for index `i` and everything after it were still untouched once read
+    bool intact(uint32_t i) const {
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return written.load(std::memory_order_relaxed) - i < N;
+    }
+
+    std::array<PoseSample, N> slots {};
+    std::atomic<uint32_t> written {0}, start {0};
+    std::atomic<uint64_t> shifted {0}; // Offset, both floats packed so they change together
+    static_assert(sizeof(Offset) == sizeof(uint64_t), "offset must pack into one atomic");
+};
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include "lemlib/asset.hpp"
+
+// Packed trajectory produced offline by `riderlib --compile <spec> static/<name>.bin` and
+// linked into the firmware with ASSET(<name>_bin). The file is a header followed by one
+// float array per column, so the firmware reads setpoints straight out of flash. Units are
+// metres and radians, heading counterclockwise from +x; theta, omega and alpha are the
+// heading the drive should hold, along the path tangent while moving.
+
+constexpr uint32_t TRAJECTORY_MAGIC = 0x4A544C52; // "RLTJ"
+constexpr uint16_t TRAJECTORY_VERSION = 3;
+
+// Columns in the order they are stored, each holding one float per point
+enum TrajectoryColumn : uint16_t {
+    TRAJ_X, TRAJ_Y, TRAJ_THETA,
+    TRAJ_VX, TRAJ_VY, TRAJ_OMEGA,
+    TRAJ_AX, TRAJ_AY, TRAJ_ALPHA,
+    TRAJ_MAX_VOLTAGE,
+    TRAJ_COLUMNS
+};
+
+struct TrajectoryAssetHeader {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t columns;
+    uint32_t points;
+    float dt; // Time between points, seconds
+};
+
+static_assert(sizeof(TrajectoryAssetHeader) == 16, "trajectory header must stay packed to 16 bytes");
+
+// Zero-copy view over a trajectory asset. Check valid() before use: a wrong magic,
+// version, size or a misaligned buffer leaves the view empty.
+class TrajectoryView {
+public:
+    explicit TrajectoryView(const asset& file) : TrajectoryView(file.buf, file.size) {}
+
+    TrajectoryView(const uint8_t* buf, size_t size) {
+        if (buf == nullptr || size < sizeof(TrajectoryAssetHeader)) return;
+        if (reinterpret_cast<uintptr_t>(buf) % alignof(float) != 0) return;
+
+        const auto* file = reinterpret_cast<const TrajectoryAssetHeader*>(buf);
+        if (file->magic != TRAJECTORY_MAGIC || file->version != TRAJECTORY_VERSION) return;
+        if (file->columns != TRAJ_COLUMNS) return;
+        if (size < sizeof(TrajectoryAssetHeader) + size_t(file->points) * TRAJ_COLUMNS * sizeof(float)) return;
+
+        header = file;
+        data = reinterpret_cast<const float*>(buf + sizeof(TrajectoryAssetHeader));
+    }
+
+    bool valid() const { return header != nullptr; }
+    uint32_t size() const { return valid() ? header->points : 0; }
+    float dt() const { return valid() ? header->dt : 0; }
+
+    const float* column(TrajectoryColumn c) const { return data + size_t(c) * header->points; }
+    float at(TrajectoryColumn c, uint32_t i) const { return column(c)[i]; }
+
+private:
+    const TrajectoryAssetHeader* header = nullptr;
+    const float* data = nullptr;
+};
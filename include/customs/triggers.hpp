@@ -0,0 +1,72 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include "pros/rtos.hpp"
+#include "lemlib/chassis/chassis.hpp"
+
+// Callbacks fired from a high-priority task when a motion reaches a distance, a deadline
+// passes or the robot enters a region. Replaces the chassis.waitUntil + subsystem call
+// pattern: the auton no longer blocks, and the action starts within one trigger tick of
+// the condition instead of whenever the next 10ms poll happens to notice it.
+
+// Firing latency from the moment the condition became true (interpolated between ticks)
+// to the callback returning
+struct TriggerLatency {
+    uint32_t count = 0;
+    uint64_t sumUs = 0;
+    uint32_t maxUs = 0;
+
+    float meanMs() const { return count == 0 ? 0 : sumUs / 1000.0f / count; }
+    float maxMs() const { return maxUs / 1000.0f; }
+};
+
+class Triggers {
+public:
+    using Callback = std::function<void()>;
+    static constexpr size_t CAPACITY = 16;
+
+    explicit Triggers(lemlib::Chassis& chassis, uint32_t period = 5) : chassis(chassis), period(period) {}
+
+    // Distance into the motion that is running now, fires early if the motion ends first
+    bool afterDistance(float dist, Callback callback);
+    // afterDistance, or when every slot is taken block in chassis.waitUntil and run it here
+    void afterDistanceOrWait(float dist, Callback callback);
+    bool afterTime(uint32_t ms, Callback callback);
+    // Fires once the robot is within radius inches of (x, y)
+    bool inRegion(float x, float y, float radius, Callback callback);
+    bool whenDone(Callback callback);
+
+    // Callback that wakes a task blocked in pros::Task::notify_take
+    static Callback notify(pros::task_t task) {
+        return [task] { pros::c::task_notify(task); };
+    }
+
+    void clear();
+    TriggerLatency latency();
+private:
+    enum class Type { DISTANCE, TIME, REGION, DONE };
+
+    struct Trigger {
+        bool armed = false;
+        Type type = Type::DONE;
+        float x = 0, y = 0, value = 0; // Distance or radius, inches
+        uint64_t deadline = 0; // pros::micros() for TIME
+        float last = -1; // Distance to the region on the previous tick
+        Callback callback;
+    };
+
+    bool add(Trigger trigger);
+    void run();
+
+    lemlib::Chassis& chassis;
+    uint32_t period;
+    std::array<Trigger, CAPACITY> slots;
+    TriggerLatency stats;
+    pros::Mutex mutex;
+    pros::Task* task = nullptr;
+};
+
+extern Triggers triggers;
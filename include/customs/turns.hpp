@@ -0,0 +1,30 @@
+#pragma once
+
+#include "customs/profile.hpp"
+#include "lemlib/chassis/chassis.hpp"
+
+// Turns that follow a motion profile built from the drivetrain's measured angular limits
+// instead of letting angularPID chase the whole error at once. Feedforward drives the
+// profile and PD on the heading error corrects around it, so a turn takes about its
+// profile duration plus a short settle rather than its full timeout.
+
+// Angular limits in deg/s and deg/s^2, feedforward in tank() power per deg/s, per deg/s^2
+// and static, PD in power per degree of heading error
+struct TurnConstants {
+    float maxVelocity, maxAcceleration;
+    float kV, kA, kS;
+    float kP, kD;
+    ProfileShape shape;
+};
+
+extern TurnConstants turnConstants;
+
+struct ProfiledTurnParams {
+    lemlib::AngularDirection direction = lemlib::AngularDirection::AUTO;
+    float maxVelocity = 0; // deg/s cap, 0 to use turnConstants
+};
+
+// Both block until the turn settles by angularSettle after its profile ends, or times out
+void profiledTurnToHeading(float theta, int timeout, ProfiledTurnParams params = {});
+// Pivots around the locked side, which holds its position
+void profiledSwingToHeading(float theta, lemlib::DriveSide lockedSide, int timeout, ProfiledTurnParams params = {});
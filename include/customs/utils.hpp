@@ -1,2 +1,11 @@
 #include "drivetrain.hpp"
-#include "autons.hpp"
\ No newline at end of file
+#include "autons.hpp"
+#include "motionqueue.hpp"
+#include "timeouts.hpp"
+#include "triggers.hpp"
+#include "follow.hpp"
+#include "boomerang.hpp"
+#include "turns.hpp"
+#include "odometry.hpp"
+#include "relocalizer.hpp"
+#include "localizer.hpp"
\ No newline at end of file
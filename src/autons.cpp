@@ -2,15 +2,18 @@
 #include "main.h"
 #include "pros/adi.h"
 #include "pros/rtos.hpp"
+
+// compiled from paths/test_path.txt by riderlib --compile
+ASSET(test_path_bin);
+
 void redRush(){
-    chassis.setPose(-55,16,180);
+    setRobotPose(-55,16,180);
     fastintake.tare_position();
     chassis.turnToPoint(-48,0,500);
     chassis.moveToPoint(-50,2,600);
     intake.move_voltage(-12000);
 
-    chassis.waitUntil(5);
-    arm.move_absolute(1000,200);
+    triggers.afterDistanceOrWait(5, [] { arm.move_absolute(1000,200); });
     chassis.turnToHeading(90,500);
     chassis.moveToPoint(-63,-1,700,{.forwards=false});
     chassis.turnToHeading(90,500);
@@ -41,14 +44,13 @@ void redRush(){
     chassis.moveToPoint(-24,48,800);*/
 }
 void blueRush(){
-    chassis.setPose(55,16,180);
+    setRobotPose(55,16,180);
     fastintake.tare_position();
     chassis.turnToPoint(48,0,500);
     chassis.moveToPoint(50,2,600);
     intake.move_voltage(-12000);
 
-    chassis.waitUntil(5);
-    arm.move_absolute(1000,200);
+    triggers.afterDistanceOrWait(5, [] { arm.move_absolute(1000,200); });
     chassis.turnToHeading(270,500);
     chassis.moveToPoint(63,-1,700,{.forwards=false});
     chassis.turnToHeading(270,600);
@@ -72,125 +74,154 @@ void blueRush(){
     chassis.moveToPoint(12, 12, 1000, {.forwards = false});
 };
 void skills(){
-    chassis.setPose(-63,0,90);
+    uint32_t start = pros::millis();
+    timeouts.begin("skills");
+    motions.chaining = true;
+    setRobotPose(-63,0,90);
     fastintake.tare_position();
     fastintake.move_absolute(-700,530);
     delay(300);
-    chassis.moveToPoint(-48,0,700,{.maxSpeed=70});
-    chassis.turnToHeading(0,600,{.maxSpeed=70});
-    arm.move_absolute(1000,100);
-    chassis.moveToPose(-48,-24,0,1400,{.forwards=false});
-    chassis.waitUntilDone();
-    clamp.toggle();
-    chassis.turnToHeading(90,800,{.maxSpeed=60});
-    chassis.moveToPoint(-24,-24,900,{.maxSpeed=60});
+    motions.moveToPoint(-48,0,700,{.maxSpeed=70});
+    motions.turnToHeading(0,600,{.maxSpeed=70});
+    motions.then([] { arm.move_absolute(1000,100); });
+    motions.moveToPose(-48,-24,0,1400,{.forwards=false});
+    motions.waitUntilDone();
+    motions.then([] { clamp.toggle(); });
+    motions.turnToHeading(90,800,{.maxSpeed=60});
+    motions.moveToPoint(-24,-24,900,{.maxSpeed=60});
 
 
-    arm.move_absolute(260,200);
-    intake.move_voltage(-11000);
-    fastintake.move_voltage(-9000);
-    chassis.turnToHeading(135,600,{.maxSpeed=60});
-    chassis.moveToPoint(1,-48,1000,{.maxSpeed=60});
-    chassis.waitUntil(5);
-    fastintake.move_voltage(0);
-    chassis.turnToHeading(180,600,{.maxSpeed=40});
-    chassis.moveToPoint(1,-64,900,{.maxSpeed=70});
-    chassis.turnToHeading(180,700);
-    chassis.waitUntilDone();
-    chassis.setPose(0,-63,180);
-    delay(50);
-    fastintake.move_relative(100, 600);
-    arm.move_absolute(1200,200);
-    delay(900);
-    chassis.moveToPoint(0,-48,1500,{.forwards=false});
-    fastintake.move_voltage(-10000);
-    chassis.turnToHeading(270, 1000, {.maxSpeed = 45});
-    chassis.moveToPoint(-48, -48, 2000, {.maxSpeed = 55});
-    chassis.moveToPoint(-60, -48, 800, {.maxSpeed = 55});
+    motions.then([] {
+        arm.move_absolute(260,200);
+        intake.move_voltage(-11000);
+        fastintake.move_voltage(-9000);
+    });
+    motions.turnToHeading(135,600,{.maxSpeed=60});
+    motions.moveToPoint(1,-48,1000,{.maxSpeed=60});
+    motions.onDistance(5, [] { fastintake.move_voltage(0); });
+    motions.turnToHeading(180,600,{.maxSpeed=40});
+    motions.moveToPoint(1,-64,900,{.maxSpeed=70});
+    motions.turnToHeading(180,700);
+    motions.waitUntilDone();
+    motions.then([] { relocalizer.relocalize({0, -63, 180}); });
+    motions.delay(50);
+    motions.then([] {
+        fastintake.move_relative(100, 600);
+        arm.move_absolute(1200,200);
+    });
+    motions.delay(900);
+    motions.moveToPoint(0,-48,1500,{.forwards=false});
+    motions.then([] { fastintake.move_voltage(-10000); });
+    motions.turnToHeading(270, 1000, {.maxSpeed = 45});
+    motions.moveToPoint(-48, -48, 2000, {.maxSpeed = 55}, 55);
+    motions.moveToPoint(-60, -48, 800, {.maxSpeed = 55});
+    if (relocalizer.sensing()) {
+        // square to the -x wall and clear of its stake, the fix that replaces ramming it later
+        motions.waitUntilDone();
+        motions.then([] { relocalizer.relocalize(); });
+    }
 
-    chassis.turnToHeading(135, 900, {.maxSpeed = 40});
-    chassis.moveToPoint(-48, -60, 1200, {.maxSpeed = 55});
-    chassis.moveToPoint(-55, -52, 1000, {.forwards=false,.maxSpeed = 55});
-    chassis.turnToHeading(45, 800, {.maxSpeed = 45});
-    chassis.moveToPoint(-60, -60, 1000, {.forwards = false});
-    chassis.waitUntilDone();
-    clamp.toggle();
-    chassis.moveToPoint(-48,1,2000,{.maxSpeed=70});
-    chassis.turnToHeading(270,600,{.maxSpeed=70});
-    chassis.moveToPoint(-63,3,1000,{.maxSpeed=50});
-    chassis.turnToHeading(270,800);
-    chassis.waitUntilDone();
-    chassis.setPose(-61.5,0,270);
-    delay(50);
-    chassis.moveToPoint(-48,4,1000, {.forwards=false,.maxSpeed = 55});
-    chassis.turnToHeading(180,800,{.maxSpeed=50});
+    motions.turnToHeading(135, 900, {.maxSpeed = 40});
+    motions.moveToPoint(-48, -60, 1200, {.maxSpeed = 55});
+    motions.moveToPoint(-55, -52, 1000, {.forwards=false,.maxSpeed = 55});
+    motions.turnToHeading(45, 800, {.maxSpeed = 45});
+    motions.moveToPoint(-60, -60, 1000, {.forwards = false});
+    motions.waitUntilDone();
+    motions.then([] { clamp.toggle(); });
+    motions.moveToPoint(-48,1,2000,{.maxSpeed=70});
+    motions.turnToHeading(270,600,{.maxSpeed=70});
+    // with the wall sensor the -x fix was taken at (-60, -48), no need to drive into the wall
+    if (!relocalizer.sensing()) {
+        motions.moveToPoint(-63,3,1000,{.maxSpeed=50});
+        motions.turnToHeading(270,800);
+        motions.waitUntilDone();
+        motions.then([] { relocalizer.relocalize({-61.5, 0, 270}); });
+        motions.delay(50);
+        motions.moveToPoint(-48,4,1000, {.forwards=false,.maxSpeed = 55});
+    }
+    motions.turnToHeading(180,800,{.maxSpeed=50});
 
-    chassis.moveToPose(-48,24,180,1600,{.forwards=false});
-    chassis.waitUntilDone();
-    clamp.toggle();
-    chassis.turnToHeading(90,800,{.maxSpeed=50});
-    chassis.moveToPoint(-24,24,900,{.maxSpeed=70});
+    motions.moveToPose(-48,24,180,1600,{.forwards=false});
+    motions.waitUntilDone();
+    motions.then([] { clamp.toggle(); });
+    motions.turnToHeading(90,800,{.maxSpeed=50});
+    motions.moveToPoint(-24,24,900,{.maxSpeed=70});
 
 
-    arm.move_absolute(260,200);
-    intake.move_voltage(-11000);
-    fastintake.move_voltage(-9000);
-    chassis.turnToHeading(45,600,{.maxSpeed=50});
-    chassis.moveToPoint(1,48,1000,{.maxSpeed=70});
-    chassis.waitUntil(10);
-    fastintake.move_voltage(0);
-    chassis.turnToHeading(0,900,{.maxSpeed=50});
-    chassis.moveToPoint(2,64,1000,{.maxSpeed=70});
-    chassis.turnToHeading(0,700);
-    chassis.waitUntilDone();
-    chassis.setPose(0,63,0);
-    delay(50);
-    fastintake.move_relative(100, 600);
-    arm.move_absolute(1200,200);
-    delay(900);
-    chassis.moveToPoint(0,48,1000,{.forwards=false,.maxSpeed=70});
-    fastintake.move_voltage(-9000);
-    chassis.turnToHeading(270, 1000, {.maxSpeed = 45});
-    chassis.moveToPoint(-48, 48, 2000, {.maxSpeed = 55});
-    chassis.moveToPoint(-60, 48, 800, {.maxSpeed = 55});
+    motions.then([] {
+        arm.move_absolute(260,200);
+        intake.move_voltage(-11000);
+        fastintake.move_voltage(-9000);
+    });
+    motions.turnToHeading(45,600,{.maxSpeed=50});
+    motions.moveToPoint(1,48,1000,{.maxSpeed=70});
+    motions.onDistance(10, [] { fastintake.move_voltage(0); });
+    motions.turnToHeading(0,900,{.maxSpeed=50});
+    motions.moveToPoint(2,64,1000,{.maxSpeed=70});
+    motions.turnToHeading(0,700);
+    motions.waitUntilDone();
+    motions.then([] { relocalizer.relocalize({0, 63, 0}); });
+    motions.delay(50);
+    motions.then([] {
+        fastintake.move_relative(100, 600);
+        arm.move_absolute(1200,200);
+    });
+    motions.delay(900);
+    motions.moveToPoint(0,48,1000,{.forwards=false,.maxSpeed=70});
+    motions.then([] { fastintake.move_voltage(-9000); });
+    motions.turnToHeading(270, 1000, {.maxSpeed = 45});
+    motions.moveToPoint(-48, 48, 2000, {.maxSpeed = 55}, 55);
+    motions.moveToPoint(-60, 48, 800, {.maxSpeed = 55});
 
-    chassis.turnToHeading(45, 900, {.maxSpeed = 40});
-    chassis.moveToPoint(-48, 60, 1200, {.maxSpeed = 55});
-    chassis.moveToPoint(-55, 52, 1000, {.forwards=false,.maxSpeed = 55});
-    chassis.turnToHeading(135, 800, {.maxSpeed = 45});
-    chassis.moveToPoint(-60, 60, 1000, {.forwards = false});
-    chassis.waitUntilDone();
-    clamp.toggle();
+    motions.turnToHeading(45, 900, {.maxSpeed = 40});
+    motions.moveToPoint(-48, 60, 1200, {.maxSpeed = 55});
+    motions.moveToPoint(-55, 52, 1000, {.forwards=false,.maxSpeed = 55});
+    motions.turnToHeading(135, 800, {.maxSpeed = 45});
+    motions.moveToPoint(-60, 60, 1000, {.forwards = false});
+    motions.waitUntilDone();
+    motions.then([] { clamp.toggle(); });
 
 
-    chassis.moveToPoint(-48, 48, 800, {.maxSpeed = 55}); 
-    fastintake.move_voltage(0);
-    chassis.moveToPoint(2,48,1400,{.maxSpeed=70});
-    chassis.turnToHeading(0,900,{.maxSpeed=50});
-    chassis.moveToPoint(2,64,1000,{.maxSpeed=70});
-    chassis.turnToHeading(0,700);
-    chassis.waitUntilDone();
-    chassis.setPose(0,63,0);
+    motions.moveToPoint(-48, 48, 800, {.maxSpeed = 55}); 
+    motions.then([] { fastintake.move_voltage(0); });
+    motions.moveToPoint(2,48,1400,{.maxSpeed=70});
+    motions.turnToHeading(0,900,{.maxSpeed=50});
+    motions.moveToPoint(2,64,1000,{.maxSpeed=70});
+    motions.turnToHeading(0,700);
+    motions.waitUntilDone();
+    motions.then([] { relocalizer.relocalize({0, 63, 0}); });
 
-    intake.move_voltage(-12000);
-    chassis.moveToPoint(0,48,600,{.forwards=false,.maxSpeed=70});
-    chassis.turnToHeading(135,800,{.maxSpeed=50});
-    chassis.moveToPoint(38,12,1200,{.maxSpeed=80});
-    chassis.waitUntil(20);
-    fastintake.move_voltage(0);
-    chassis.moveToPoint(48,-1,1200,{.maxSpeed=80});
-    chassis.turnToHeading(270,700,{.maxSpeed=50});
-    chassis.moveToPoint(66,1,1000,{.forwards=false,.maxSpeed=70});
-    chassis.turnToHeading(270,900);
-    chassis.waitUntilDone();
-    chassis.setPose(63,0,270);
-    fastintake.move_voltage(-10000);
-    delay(800);
-    chassis.turnToHeading(0,800,{.maxSpeed=80});
-    chassis.moveToPoint(64,62,3000,{.maxSpeed=80});
-    chassis.moveToPoint(60,0,1200,{.forwards=false,.maxSpeed=80});
-    chassis.turnToHeading(180,800,{.maxSpeed=60});
-    chassis.moveToPoint(64,-62,3000,{.maxSpeed=80});
+    motions.then([] { intake.move_voltage(-12000); });
+    motions.moveToPoint(0,48,600,{.forwards=false,.maxSpeed=70});
+    motions.turnToHeading(135,800,{.maxSpeed=50});
+    motions.moveToPoint(38,12,1200,{.maxSpeed=80},70);
+    motions.onDistance(20, [] { fastintake.move_voltage(0); });
+    motions.moveToPoint(48,-1,1200,{.maxSpeed=80});
+    motions.turnToHeading(270,700,{.maxSpeed=50});
+    motions.moveToPoint(66,1,1000,{.forwards=false,.maxSpeed=70});
+    motions.turnToHeading(270,900);
+    motions.waitUntilDone();
+    motions.then([] {
+        relocalizer.relocalize({63, 0, 270});
+        fastintake.move_voltage(-10000);
+    });
+    motions.delay(800);
+    motions.turnToHeading(0,800,{.maxSpeed=80});
+    motions.moveToPoint(64,62,3000,{.maxSpeed=80});
+    motions.moveToPoint(60,0,1200,{.forwards=false,.maxSpeed=80});
+    motions.turnToHeading(180,800,{.maxSpeed=60});
+    motions.moveToPoint(64,-62,3000,{.maxSpeed=80});
+    motions.waitUntilEmpty();
+    lemlib::infoSink()->info("skills finished in {} ms", pros::millis() - start);
+    timeouts.save();
+    TriggerLatency latency = triggers.latency();
+    lemlib::infoSink()->info("{} triggers, latency mean {:.2f} ms max {:.2f} ms", latency.count, latency.meanMs(), latency.maxMs());
+    OdometryTiming timing = odometry.timing();
+    lemlib::infoSink()->info("odometry jitter mean {:.2f} ms max {:.2f} ms, staleness vertical {:.2f}/{:.2f} ms, "
+                             "horizontal {:.2f}/{:.2f} ms, imu {:.2f}/{:.2f} ms, drive {:.2f}/{:.2f} ms, filter max {} us",
+                             timing.jitter.meanMs(), timing.jitter.maxMs(), timing.vertical.meanMs(), timing.vertical.maxMs(),
+                             timing.horizontal.meanMs(), timing.horizontal.maxMs(), timing.imu.meanMs(), timing.imu.maxMs(),
+                             timing.drive.meanMs(), timing.drive.maxMs(), timing.filterMaxUs);
     /* chassis.turnToHeading(-45,800,{.maxSpeed=50});
     chassis.moveToPose(45,45,-45,1200,{.forwards=false});
     chassis.waitUntilDone();
@@ -212,14 +243,13 @@ void skills(){
 void elimRed(){};
 void elimBlue(){};
 void redSoloWP(){
-    chassis.setPose(-55,16,180);
+    setRobotPose(-55,16,180);
     fastintake.tare_position();
     chassis.turnToPoint(-48,0,600, {.maxSpeed = 55});
     chassis.moveToPoint(-50,2,800, {.maxSpeed = 55});
     intake.move_voltage(-12000);
 
-    chassis.waitUntil(5);
-    arm.move_absolute(1000,200);
+    triggers.afterDistanceOrWait(5, [] { arm.move_absolute(1000,200); });
     chassis.turnToHeading(90,800, {.maxSpeed = 55});
     chassis.moveToPoint(-63,-1,700,{.forwards=false});
     chassis.turnToHeading(90,900);
@@ -239,14 +269,13 @@ void redSoloWP(){
     arm.move_absolute(500,200);
 };
 void blueSoloWP(){
-    chassis.setPose(55,16,180);
+    setRobotPose(55,16,180);
     fastintake.tare_position();
     chassis.turnToPoint(48,0,600, {.maxSpeed = 55});
     chassis.moveToPoint(50,2,800, {.maxSpeed = 55});
     intake.move_voltage(-12000);
 
-    chassis.waitUntil(5);
-    arm.move_absolute(1000,200);
+    triggers.afterDistanceOrWait(5, [] { arm.move_absolute(1000,200); });
     chassis.turnToHeading(270,800, {.maxSpeed = 55});
     chassis.moveToPoint(63,-1,700,{.forwards=false});
     chassis.turnToHeading(270,900);
@@ -265,4 +294,13 @@ void blueSoloWP(){
     chassis.waitUntilDone();
     arm.move_absolute(500,200);
 };
-    
\ No newline at end of file
+    
+// (-48, 0) to the ring stack at (-24, -24) on a compiled trajectory. A bench test, not in the
+// match selector: call it from autonomous() to run it
+void trajectoryTest(){
+    TrajectoryView path(test_path_bin);
+    if (!path.valid()) return;
+    lemlib::Pose start = trajectoryPose(path, 0);
+    setRobotPose(start.x, start.y, start.theta);
+    followTrajectory(path, 3500);
+};
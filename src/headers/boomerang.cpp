@@ -0,0 +1,63 @@
+#include "main.h"
+#include "customs/boomerang.hpp"
+#include "lemlib/chassis/odom.hpp"
+
+void boomerangToPose(float x, float y, float theta, int timeout, BoomerangParams params) {
+    chassis.waitUntilDone();
+
+    // backing onto a pose travels along the opposite heading
+    float travel = params.forwards ? theta : theta + 180;
+    BoomerangTarget target(x, y, travel, params.lead);
+    const PathLimits& limits = followConstants.limits;
+    float maxVelocity = limits.maxVelocity * params.maxSpeed / 127;
+    float minVelocity = limits.maxVelocity * params.minSpeed / 127;
+    // planned a little under the limit, the drive lags behind a speed cap that drops into a corner
+    float lateral = 0.9f * (params.maxLateralAcceleration > 0 ? params.maxLateralAcceleration : limits.maxLateralAcceleration);
+
+    SettleDetector settle(lateralSettle), arrive(lateralSettle);
+    float previousError = 0;
+    uint32_t start = pros::millis();
+    uint32_t wake = start;
+    while (pros::millis() - start < uint32_t(timeout)) {
+        lemlib::Pose pose = chassis.getPose(true);
+        if (!params.forwards) pose.theta += M_PI;
+        float sinHeading = std::sin(pose.theta), cosHeading = std::cos(pose.theta);
+
+        float distance = target.distance(pose.x, pose.y);
+        if (params.minSpeed > 0 && distance < params.earlyExitRange) return;
+        // signed distance left along the heading, negative once past the target
+        float along = (target.x - pose.x) * sinHeading + (target.y - pose.y) * cosHeading;
+
+        // like LemLib, within 7.5 in drive straight at the target and turn onto its heading
+        bool close = distance < 7.5f;
+        float cx = target.x, cy = target.y;
+        if (!close) target.carrot(pose.x, pose.y, cx, cy);
+        float curvature = close ? 0 : arcCurvature(pose.x, pose.y, sinHeading, cosHeading, cx, cy);
+        float remaining = close ? std::fabs(along) : std::hypot(cx - pose.x, cy - pose.y) + std::hypot(target.x - cx, target.y - cy);
+
+        float velocity = std::fmax(boomerangSpeed(curvature, remaining, maxVelocity, limits.maxAcceleration, lateral), minVelocity);
+        if (close && along < 0) velocity = -velocity;
+        float measured = lemlib::getLocalSpeed().y;
+        if (!params.forwards) measured = -measured;
+
+        float forward = followConstants.kV * velocity + (velocity == 0 ? 0 : std::copysign(followConstants.kS, velocity)) +
+                        followConstants.kP * (velocity - measured);
+        // angular velocity the arc needs at this speed, through the turn feedforward so it does
+        // not depend on the configured track width
+        float error = close ? lemlib::angleError(travel, lemlib::radToDeg(pose.theta), false) : 0;
+        float turn = turnConstants.kV * lemlib::radToDeg(velocity * curvature) + turnConstants.kP * error +
+                     turnConstants.kD * (error - previousError) / 0.01f;
+        previousError = error;
+        turn = std::clamp(turn, -127.0f, 127.0f);
+        forward = std::clamp(forward, -(127 - std::fabs(turn)), 127 - std::fabs(turn));
+        // settled along the heading and on the straight distance too, a robot level with the
+        // target but off to the side has no along error. Both update every tick
+        if (params.minSpeed == 0 && (settle.update(along, forward, 10) & arrive.update(distance, forward, 10))) break;
+
+        // positive turn is clockwise, left faster; backwards the sides swap
+        if (params.forwards) chassis.tank(forward + turn, forward - turn, true);
+        else chassis.tank(-(forward - turn), -(forward + turn), true);
+        pros::Task::delay_until(&wake, 10);
+    }
+    chassis.tank(0, 0, true);
+}
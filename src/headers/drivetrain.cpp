@@ -22,6 +22,9 @@ Motor arm(10,MotorGearset::green);
 Imu imu(8);
 Optical color(9);
 Distance dist(17);
+// where dist sits, inches right of and ahead of the tracking centre and which way it faces.
+// Not measured yet, keep wallSensing in initialize() off until it is
+SensorMount distMount {0, 0, 0};
 // tracking wheels
 // horizontal tracking wheel encoder. Rotation sensor, port 20, reversed
 Rotation horizontalEnc(1);
@@ -89,5 +92,59 @@ lemlib::ExpoDriveCurve steerCurve(3, // joystick deadband out of 127
                                   1.019 // expo curve gain
 );
 
+// path following limits and feedforward, tank() power per in/s, per in/s^2 and static
+FollowConstants followConstants {{60, // max velocity, in/s. 343 rpm on 4" omnis is about 74
+                                  80, // max acceleration, in/s^2
+                                  60}, // max lateral acceleration before the omnis slide, in/s^2
+                                 1.7, // kV, 127 / 74 in/s
+                                 0.12, // kA
+                                 6, // kS
+                                 1.0 // kP on forward speed
+};
+
+// settle detection for queued motions and profiled turns
+SettleParams lateralSettle {1, // error range, inches
+                            2, // still below this many in/s
+                            20, // output range, out of 127
+                            60, // ms inside all three
+                            4, // stall range, inches
+                            150 // ms stopped inside the stall range
+};
+SettleParams angularSettle {1, // error range, degrees
+                            10, // still below this many deg/s
+                            20, // output range, out of 127
+                            60, // ms inside all three
+                            5, // stall range, degrees
+                            150 // ms stopped inside the stall range
+};
+
+// profiled turns, measured limits and feedforward in tank() power
+TurnConstants turnConstants {450, // max angular velocity, deg/s
+                             1500, // max angular acceleration, deg/s^2
+                             0.18, // kV, 127 / 700 deg/s at full power
+                             0.045, // kA
+                             6, // kS
+                             6, // kP on heading error
+                             0.4, // kD
+                             ProfileShape::S_CURVE
+};
+
 // create the chassis
 lemlib::Chassis chassis(drivetrain, linearController, angularController, sensors, &throttleCurve, &steerCurve);
+
+// time-aligned odometry on the same sensors, off the chassis until driveChassis is set
+TimedOdometry odometry(verticalEnc, horizontalEnc, imu, leftMotors, rightMotors,
+                       {2, -3.35, // vertical wheel diameter and offset, as `vertical`
+                        2, -7.5, // horizontal wheel diameter and offset, as `horizontal`
+                        lemlib::Omniwheel::OLD_4, 343});
+// distance sensors against the walls, standing in for wall resets
+Relocalizer relocalizer(chassis);
+// particle filter over the whole field map, a cross-check on the chassis pose once started
+ParticleLocalizer localizer(chassis);
+
+// commands run by the auton queue task
+MotionQueue motions(chassis);
+// subsystem actions fired from inside motions
+Triggers triggers(chassis);
+// per-motion timeout history on the SD card, logs tightened timeouts until set to APPLY
+TimeoutLearner timeouts;
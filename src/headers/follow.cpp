@@ -0,0 +1,121 @@
+#include "main.h"
+#include "customs/follow.hpp"
+#include "lemlib/chassis/odom.hpp"
+
+// compiled trajectories are in metres, heading counterclockwise from +x
+constexpr float INCHES_PER_METRE = 39.3701f;
+
+// Turn power that holds a curvature at a forward speed in in/s, through the turn feedforward
+// like boomerang so it does not depend on the configured track width. Positive curvature is
+// LemLib's clockwise, left side faster
+static float turnPower(float velocity, float acceleration, float curvature) {
+    return turnConstants.kV * lemlib::radToDeg(velocity * curvature) + turnConstants.kA * lemlib::radToDeg(acceleration * curvature);
+}
+
+void followPath(const CompiledPath& path, float lookahead, int timeout, bool forwards) {
+    if (path.size() < 2) return;
+    chassis.waitUntilDone();
+
+    size_t closest = 0;
+    float target = 0;
+    uint32_t start = pros::millis();
+    uint32_t wake = start;
+    while (pros::millis() - start < uint32_t(timeout)) {
+        lemlib::Pose pose = chassis.getPose(true, true);
+        if (!forwards) pose.theta += M_PI;
+
+        // the robot covers well under a lookahead per tick, so that is enough window
+        closest = closestPoint(path, pose.x, pose.y, closest, lookahead);
+        if (closest == path.size() - 1) break;
+        target = lookaheadIndex(path, pose.x, pose.y, lookahead, closest, target);
+
+        lemlib::Pose carrot(0, 0);
+        pathPoint(path, target, carrot.x, carrot.y);
+        float curvature = lemlib::getCurvature(pose, carrot);
+
+        float forward, turn;
+        if (path.velocity.empty()) {
+            forward = path.speed[closest] * 127;
+            turn = turnPower(forward / followConstants.kV, 0, curvature);
+        } else {
+            // the closest point lags the robot, so aim at the next one or it never leaves the start
+            size_t ahead = std::min(closest + 1, path.size() - 1);
+            float velocity = path.velocity[ahead], acceleration = path.acceleration[closest];
+            float measured = lemlib::getLocalSpeed().y;
+            if (!forwards) measured = -measured;
+            forward = followConstants.kV * velocity + followConstants.kA * acceleration +
+                      (velocity == 0 ? 0 : std::copysign(followConstants.kS, velocity)) +
+                      followConstants.kP * (velocity - measured);
+            turn = turnPower(velocity, acceleration, curvature);
+        }
+        float left = forward + turn, right = forward - turn;
+        if (!forwards) {
+            left = -left;
+            right = -right;
+        }
+        float ratio = std::fmax(std::fabs(left), std::fabs(right)) / 127;
+        if (ratio > 1) {
+            left /= ratio;
+            right /= ratio;
+        }
+        chassis.tank(left, right, true);
+        pros::Task::delay_until(&wake, 10);
+    }
+    chassis.tank(0, 0, true);
+}
+
+lemlib::Pose trajectoryPose(const TrajectoryView& trajectory, uint32_t i) {
+    return {trajectory.at(TRAJ_X, i) * INCHES_PER_METRE, trajectory.at(TRAJ_Y, i) * INCHES_PER_METRE,
+            lemlib::radToDeg(float(M_PI) / 2 - trajectory.at(TRAJ_THETA, i))};
+}
+
+void followTrajectory(const TrajectoryView& trajectory, int timeout, TrajectoryParams params) {
+    if (trajectory.size() < 2) return;
+    chassis.waitUntilDone();
+
+    const uint32_t last = trajectory.size() - 1;
+    uint32_t start = pros::millis();
+    uint32_t wake = start;
+    while (pros::millis() - start < uint32_t(timeout)) {
+        // the point due now, so a late tick catches up instead of falling behind
+        uint32_t i = std::min(uint32_t((pros::millis() - start) / 1000.0f / trajectory.dt()), last);
+        float x = trajectory.at(TRAJ_X, i) * INCHES_PER_METRE, y = trajectory.at(TRAJ_Y, i) * INCHES_PER_METRE;
+        float theta = trajectory.at(TRAJ_THETA, i);
+        float omega = trajectory.at(TRAJ_OMEGA, i), alpha = trajectory.at(TRAJ_ALPHA, i);
+        // speed and acceleration along the heading the point asks for
+        float sinTheta = std::sin(theta), cosTheta = std::cos(theta);
+        float velocity = (trajectory.at(TRAJ_VX, i) * cosTheta + trajectory.at(TRAJ_VY, i) * sinTheta) * INCHES_PER_METRE;
+        float acceleration = (trajectory.at(TRAJ_AX, i) * cosTheta + trajectory.at(TRAJ_AY, i) * sinTheta) * INCHES_PER_METRE;
+
+        // the chassis pose in the trajectory's convention, and the error in the robot's frame
+        lemlib::Pose pose = chassis.getPose(true);
+        float heading = float(M_PI) / 2 - pose.theta;
+        float sinHeading = std::sin(heading), cosHeading = std::cos(heading);
+        float dx = x - pose.x, dy = y - pose.y;
+        float alongError = cosHeading * dx + sinHeading * dy, acrossError = cosHeading * dy - sinHeading * dx;
+        float headingError = std::remainder(theta - heading, 2 * float(M_PI));
+
+        // RAMSETE
+        float k = 2 * params.zeta * std::sqrt(omega * omega + params.b * velocity * velocity);
+        float sinc = std::fabs(headingError) < 1e-4f ? 1 : std::sin(headingError) / headingError;
+        float v = velocity * std::cos(headingError) + k * alongError;
+        float w = omega + k * headingError + params.b * velocity * sinc * acrossError;
+
+        float measured = lemlib::getLocalSpeed().y;
+        float forward = followConstants.kV * v + followConstants.kA * acceleration +
+                        (v == 0 ? 0 : std::copysign(followConstants.kS, v)) + followConstants.kP * (v - measured);
+        // counterclockwise turn rate through the turn feedforward, where positive is clockwise
+        float turn = -(turnConstants.kV * lemlib::radToDeg(w) + turnConstants.kA * lemlib::radToDeg(alpha));
+
+        float left = forward + turn, right = forward - turn;
+        float ratio = std::fmax(std::fabs(left), std::fabs(right)) / (127 * trajectory.at(TRAJ_MAX_VOLTAGE, i) / 12);
+        if (ratio > 1) {
+            left /= ratio;
+            right /= ratio;
+        }
+        chassis.tank(left, right, true);
+        if (i == last) break;
+        pros::Task::delay_until(&wake, 10);
+    }
+    chassis.tank(0, 0, true);
+}
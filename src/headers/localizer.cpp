@@ -0,0 +1,78 @@
+#include "main.h"
+#include <algorithm>
+#include "customs/localizer.hpp"
+
+bool ParticleLocalizer::addSensor(pros::Distance& sensor, SensorMount mount) {
+    if (count == CAPACITY) return false;
+    sensors[count++] = {&sensor, mount};
+    return true;
+}
+
+void ParticleLocalizer::start(PlanarPose pose, float spread, float headingSpread) {
+    mutex.take();
+    filter.reset(pose, spread, headingSpread);
+    last = odometry.motion();
+    estimate = pose;
+    agreement = spread;
+    mutex.give();
+    if (task != nullptr) return;
+    task = new pros::Task([this] {
+        uint32_t time = pros::millis();
+        while (true) {
+            step();
+            pros::Task::delay_until(&time, period);
+        }
+    }, "localizer");
+}
+
+void ParticleLocalizer::step() {
+    uint64_t begin = pros::micros();
+    PlanarPose now = odometry.motion();
+    mutex.take();
+    // odometry's motion since the last step, in the robot's frame at the midpoint heading.
+    // The motion frame is only turned and shifted from the field, so the robot frame is the same
+    float dx = now.x - last.x, dy = now.y - last.y, dTheta = now.theta - last.theta;
+    float heading = last.theta + dTheta / 2, s = std::sin(heading), c = std::cos(heading);
+    filter.predict(dx * s + dy * c, dx * c - dy * s, dTheta);
+    last = now;
+
+    for (size_t i = 0; i < count; i++) {
+        std::int32_t mm = sensors[i].sensor->get_distance();
+        // 9999 is nothing in range
+        if (mm == PROS_ERR || mm >= 9999) continue;
+        filter.update(sensors[i].mount, mm / 25.4f);
+    }
+    estimate = filter.estimate();
+    agreement = filter.spread();
+    if (gain > 0 && agreement < trust) {
+        // both, as the relocalizer does, nudging the timed odometry rather than resetting it
+        lemlib::Pose current = chassis.getPose(true);
+        PlanarPose corrected = {current.x + gain * (estimate.x - current.x), current.y + gain * (estimate.y - current.y),
+                                current.theta};
+        chassis.setPose(corrected.x, corrected.y, corrected.theta, true);
+        odometry.shift(corrected.x - current.x, corrected.y - current.y);
+    }
+    worst = std::max(worst, uint32_t(pros::micros() - begin));
+    mutex.give();
+}
+
+PlanarPose ParticleLocalizer::pose() {
+    mutex.take();
+    PlanarPose pose = estimate;
+    mutex.give();
+    return pose;
+}
+
+float ParticleLocalizer::spread() {
+    mutex.take();
+    float spread = agreement;
+    mutex.give();
+    return spread;
+}
+
+uint32_t ParticleLocalizer::worstUs() {
+    mutex.take();
+    uint32_t us = worst;
+    mutex.give();
+    return us;
+}
@@ -0,0 +1,287 @@
+#include "main.h"
+#include "customs/motionqueue.hpp"
+#include "customs/triggers.hpp"
+#include <cmath>
+#include <cstdio>
+
+// Early exit distance (inches, or degrees for turns) that lets the next motion take over
+// before this one starts braking: roughly how far the robot covers at the handoff speed
+// in the 100ms it takes the controller to swing its output around
+static float handoffRange(const QueuedCommand& command) {
+    float fraction = command.handoffSpeed / 127;
+    return command.isTurn() ? 2 + 10 * fraction : 1 + 6 * fraction;
+}
+
+static bool isMove(const QueuedCommand& command) {
+    return command.type == QueuedCommand::Type::MOVE_TO_POINT || command.type == QueuedCommand::Type::MOVE_TO_POSE;
+}
+
+static bool movesForwards(const QueuedCommand& command) {
+    if (command.type == QueuedCommand::Type::MOVE_TO_POSE) return std::get<lemlib::MoveToPoseParams>(command.params).forwards;
+    return std::get<lemlib::MoveToPointParams>(command.params).forwards;
+}
+
+// Handoff from the geometry of the move from (startX, startY) and the move after it. A move
+// to a pose arrives along its heading rather than straight from where it started
+static Handoff planChain(const QueuedCommand& command, const QueuedCommand& next, float startX, float startY) {
+    if (!isMove(next) || movesForwards(command) != movesForwards(next)) return {};
+    float inX = command.x - startX, inY = command.y - startY;
+    if (command.type == QueuedCommand::Type::MOVE_TO_POSE) {
+        float length = std::hypot(inX, inY) * (movesForwards(command) ? 1 : -1);
+        inX = length * std::sin(lemlib::degToRad(command.theta));
+        inY = length * std::cos(lemlib::degToRad(command.theta));
+    }
+    auto maxSpeed = [](const QueuedCommand& motion) { return std::visit([](auto& params) { return float(params.maxSpeed); }, motion.params); };
+    return planHandoff(inX, inY, next.x - command.x, next.y - command.y, std::fmin(maxSpeed(command), maxSpeed(next)),
+                       followConstants.limits);
+}
+
+// While chaining, a move pushed without a handoff speed has one planned once its successor is known
+float MotionQueue::chained(float handoffSpeed) const {
+    return handoffSpeed == 0 && chaining ? QueuedCommand::AUTO_HANDOFF : handoffSpeed;
+}
+
+void MotionQueue::moveToPoint(float x, float y, int timeout, lemlib::MoveToPointParams params, float handoffSpeed) {
+    push({.type = QueuedCommand::Type::MOVE_TO_POINT, .x = x, .y = y, .timeout = timeout, .params = params, .handoffSpeed = chained(handoffSpeed)});
+}
+
+void MotionQueue::moveToPose(float x, float y, float theta, int timeout, lemlib::MoveToPoseParams params, float handoffSpeed) {
+    push({.type = QueuedCommand::Type::MOVE_TO_POSE, .x = x, .y = y, .theta = theta, .timeout = timeout, .params = params, .handoffSpeed = chained(handoffSpeed)});
+}
+
+void MotionQueue::turnToHeading(float theta, int timeout, lemlib::TurnToHeadingParams params, float handoffSpeed) {
+    push({.type = QueuedCommand::Type::TURN_TO_HEADING, .theta = theta, .timeout = timeout, .params = params, .handoffSpeed = handoffSpeed});
+}
+
+void MotionQueue::turnToPoint(float x, float y, int timeout, lemlib::TurnToPointParams params, float handoffSpeed) {
+    push({.type = QueuedCommand::Type::TURN_TO_POINT, .x = x, .y = y, .timeout = timeout, .params = params, .handoffSpeed = handoffSpeed});
+}
+
+void MotionQueue::swingToHeading(float theta, lemlib::DriveSide side, int timeout, lemlib::SwingToHeadingParams params, float handoffSpeed) {
+    push({.type = QueuedCommand::Type::SWING_TO_HEADING, .theta = theta, .timeout = timeout, .side = side, .params = params, .handoffSpeed = handoffSpeed});
+}
+
+void MotionQueue::then(std::function<void()> action) {
+    push({.type = QueuedCommand::Type::ACTION, .action = std::move(action)});
+}
+
+void MotionQueue::onDistance(float dist, std::function<void()> action) {
+    then([dist, action = std::move(action)] { triggers.afterDistanceOrWait(dist, action); });
+}
+
+void MotionQueue::waitUntil(float dist) {
+    push({.type = QueuedCommand::Type::WAIT_UNTIL, .x = dist});
+}
+
+void MotionQueue::waitUntilDone() {
+    push({.type = QueuedCommand::Type::WAIT_UNTIL_DONE});
+}
+
+void MotionQueue::delay(int ms) {
+    push({.type = QueuedCommand::Type::DELAY, .timeout = ms});
+}
+
+void MotionQueue::push(QueuedCommand command) {
+    // The queue task is created on first use, global constructors run before the scheduler
+    if (task == nullptr) task = new pros::Task([this] { run(); }, "motion queue");
+
+    while (true) {
+        mutex.take();
+        if (count < CAPACITY) {
+            buffer[(head + count) % CAPACITY] = std::move(command);
+            count++;
+            mutex.give();
+            break;
+        }
+        mutex.give();
+        pros::delay(10); // full, wait for the queue task to catch up
+    }
+    task->notify();
+}
+
+bool MotionQueue::idle() {
+    mutex.take();
+    bool empty = count == 0 && !busy;
+    mutex.give();
+    return empty;
+}
+
+void MotionQueue::waitUntilEmpty() {
+    while (!idle()) pros::delay(10);
+    chassis.waitUntilDone();
+}
+
+void MotionQueue::clear() {
+    mutex.take();
+    count = 0;
+    // the running motion is cancelled rather than finished, so it is never reported to timeouts
+    pending = watching = false;
+    generation++;
+    mutex.give();
+    chassis.cancelAllMotions();
+}
+
+// Called with the mutex held on the command at buffer[index]. A motion only hands off at
+// speed when the next motion is already queued with only actions or waitUntil in between,
+// waitUntilDone or a delay means the routine needs the robot to actually arrive
+void MotionQueue::blend(QueuedCommand& command, size_t index) {
+    if (!command.isMotion() || command.handoffSpeed == 0) return;
+    bool plan = command.handoffSpeed == QueuedCommand::AUTO_HANDOFF;
+    if (plan) command.handoffSpeed = 0;
+    for (size_t i = 1; i < count; i++) {
+        const QueuedCommand& next = buffer[(index + i) % CAPACITY];
+        if (next.type == QueuedCommand::Type::ACTION) continue;
+        if (next.type == QueuedCommand::Type::WAIT_UNTIL) continue; // mid-motion, does not need arrival
+        if (!next.isMotion()) return;
+
+        float range = handoffRange(command);
+        if (plan) {
+            // this move starts where the one still running was headed, or where the robot is
+            lemlib::Pose start = pending && isMove(current) ? lemlib::Pose(current.x, current.y) : chassis.getPose();
+            Handoff handoff = planChain(command, next, start.x, start.y);
+            if (handoff.speed == 0) return;
+            command.handoffSpeed = handoff.speed;
+            range = handoff.range;
+        }
+        std::visit([&](auto& params) {
+            params.minSpeed = std::fmax(params.minSpeed, command.handoffSpeed);
+            params.earlyExitRange = std::fmax(params.earlyExitRange, range);
+        }, command.params);
+        return;
+    }
+}
+
+// Distance or heading still to go for a queued motion
+static float motionError(const QueuedCommand& command, lemlib::Pose pose) {
+    using Type = QueuedCommand::Type;
+    switch (command.type) {
+        case Type::MOVE_TO_POINT:
+        case Type::MOVE_TO_POSE: return std::hypot(command.x - pose.x, command.y - pose.y);
+        case Type::TURN_TO_POINT: {
+            float heading = lemlib::radToDeg(std::atan2(command.x - pose.x, command.y - pose.y));
+            if (!std::get<lemlib::TurnToPointParams>(command.params).forwards) heading += 180;
+            return lemlib::angleError(heading, pose.theta, false);
+        }
+        default: return lemlib::angleError(command.theta, pose.theta, false);
+    }
+}
+
+// What the motion is still commanding out of 127, from the drive motors' voltage
+static float driveOutput(const QueuedCommand& command) {
+    float left = drivetrain.leftMotors->get_voltage() * 127 / 12000.0f;
+    float right = drivetrain.rightMotors->get_voltage() * 127 / 12000.0f;
+    return command.isTurn() ? (left - right) / 2 : (left + right) / 2;
+}
+
+// Waits for the running motion to end. A watched motion is cancelled as soon as its settle
+// detector is satisfied, rather than running on to its timeout on the zero exit ranges.
+void MotionQueue::waitForMotion() {
+    SettleDetector detector(current.isTurn() ? angularSettle : lateralSettle);
+    uint32_t last = pros::millis();
+    if (watching && logSettle) std::printf("motion %d %d %s\n", motionIndex, current.timeout, current.isTurn() ? "turn" : "move");
+    while (chassis.isInMotion()) {
+        pros::delay(10);
+        if (!watching) continue;
+        uint32_t now = pros::millis();
+        float error = motionError(current, chassis.getPose());
+        float output = driveOutput(current);
+        if (logSettle) std::printf("%u %.3f %.1f\n", now - currentStart, error, output);
+        if (detector.update(error, output, now - last)) {
+            chassis.cancelMotion();
+            break;
+        }
+        last = now;
+    }
+    mutex.take();
+    bool report = pending;
+    watching = pending = false;
+    mutex.give();
+    if (report) {
+        // anything that ended well short of its timeout got there, settled or handed off
+        int duration = pros::millis() - currentStart;
+        timeouts.finish(duration, detector.settled() || duration < current.timeout - 20);
+    }
+}
+
+// Whether clear() ran since the command being executed was taken off the queue
+bool MotionQueue::cleared() {
+    mutex.take();
+    bool stale = generation != taken;
+    mutex.give();
+    return stale;
+}
+
+// Mirrors what the auton would have done calling the chassis directly: each motion starts
+// once the previous one ends, and the call returns as soon as it has started
+void MotionQueue::execute(QueuedCommand& command) {
+    using Type = QueuedCommand::Type;
+    if (command.isMotion()) {
+        waitForMotion();
+        if (cleared()) return;
+        command.timeout = timeouts.start(command.timeout);
+    }
+    switch (command.type) {
+        case Type::MOVE_TO_POINT:
+            chassis.moveToPoint(command.x, command.y, command.timeout, std::get<lemlib::MoveToPointParams>(command.params));
+            break;
+        case Type::MOVE_TO_POSE:
+            chassis.moveToPose(command.x, command.y, command.theta, command.timeout, std::get<lemlib::MoveToPoseParams>(command.params));
+            break;
+        case Type::TURN_TO_HEADING:
+            chassis.turnToHeading(command.theta, command.timeout, std::get<lemlib::TurnToHeadingParams>(command.params));
+            break;
+        case Type::TURN_TO_POINT:
+            chassis.turnToPoint(command.x, command.y, command.timeout, std::get<lemlib::TurnToPointParams>(command.params));
+            break;
+        case Type::SWING_TO_HEADING:
+            chassis.swingToHeading(command.theta, command.side, command.timeout, std::get<lemlib::SwingToHeadingParams>(command.params));
+            break;
+        case Type::ACTION: command.action(); break;
+        case Type::WAIT_UNTIL: chassis.waitUntil(command.x); break;
+        case Type::WAIT_UNTIL_DONE: waitForMotion(); break;
+        case Type::DELAY: pros::delay(command.timeout); break;
+    }
+    if (command.isMotion()) {
+        mutex.take();
+        bool live = generation == taken;
+        if (live) {
+            current = command;
+            currentStart = pros::millis();
+            motionIndex++;
+            pending = true;
+            // a motion handing off at speed is meant to exit moving, so leave it alone
+            watching = std::visit([](auto& params) { return params.minSpeed == 0; }, command.params);
+        }
+        mutex.give();
+        // cleared while it was starting, so it goes with the rest of the queue
+        if (!live) chassis.cancelAllMotions();
+    }
+}
+
+void MotionQueue::run() {
+    while (true) {
+        mutex.take();
+        if (count == 0 && pending) {
+            // keep watching the last motion so waitUntilEmpty returns once it has settled and
+            // its time is recorded
+            mutex.give();
+            waitForMotion();
+            continue;
+        }
+        if (count == 0) {
+            busy = false;
+            mutex.give();
+            pros::Task::notify_take(true, TIMEOUT_MAX);
+            continue;
+        }
+        QueuedCommand command = std::move(buffer[head]);
+        blend(command, head);
+        head = (head + 1) % CAPACITY;
+        count--;
+        busy = true;
+        taken = generation;
+        mutex.give();
+
+        execute(command);
+    }
+}
@@ -0,0 +1,236 @@
+#include "main.h"
+#include "customs/odometry.hpp"
+#include <algorithm>
+
+// A sensor without timestamps reports the same value until its next sample, so a reading is
+// stamped when it changes. One that has not changed for a couple of its sample periods is
+// sitting still and gets stamped anyway, or its latest sample would look older every tick
+static void pushChanged(TimedSignal<>& signal, uint64_t now, float value) {
+    const uint64_t hold = 20000; // us
+    if (signal.size() == 0 || value != signal.latest() || now - signal.latestTime() >= hold) signal.push(now, value);
+}
+
+// Which way each motor of a group counts. Raw counts ignore the port's reversal, so it is
+// read once here rather than every tick
+static void readSigns(pros::MotorGroup& group, MotorSigns& signs) {
+    signs.count = std::min<size_t>(std::max<int>(group.size(), 0), signs.sign.size());
+    for (size_t i = 0; i < signs.count; i++) signs.sign[i] = group.is_reversed(i) == 1 ? -1 : 1;
+}
+
+// Mean encoder count of a motor group, one motor at a time so nothing is allocated, stamped
+// with the oldest of their samples
+static float meanCounts(pros::MotorGroup& group, const MotorSigns& signs, uint32_t* stamp) {
+    if (signs.count == 0) return NAN;
+    float sum = 0;
+    uint32_t oldest = UINT32_MAX;
+    for (size_t i = 0; i < signs.count; i++) {
+        uint32_t time = 0;
+        std::int32_t counts = group.get_raw_position(&time, i);
+        if (counts == PROS_ERR) return NAN;
+        sum += signs.sign[i] * counts;
+        oldest = std::min(oldest, time);
+    }
+    *stamp = oldest;
+    return sum / signs.count;
+}
+
+// Encoder counts per output shaft turn and free speed of a cartridge
+static void cartridge(pros::MotorGears gears, float& counts, float& rpm) {
+    switch (gears) {
+        case pros::MotorGears::red: counts = 1800, rpm = 100; break;
+        case pros::MotorGears::green: counts = 900, rpm = 200; break;
+        default: counts = 300, rpm = 600; break;
+    }
+}
+
+void TimedOdometry::sample(uint64_t now) {
+    uint32_t leftStamp = 0, rightStamp = 0;
+    float leftCounts = meanCounts(left, leftSigns, &leftStamp), rightCounts = meanCounts(right, rightSigns, &rightStamp);
+    if (!std::isnan(leftCounts) && !std::isnan(rightCounts)) {
+        float counts, rpm;
+        cartridge(left.get_gearing(), counts, rpm);
+        float revolutions = (leftCounts + rightCounts) / 2 / counts * geometry.driveRpm / rpm;
+        // the motors stamp their own samples in ms, the older of the two sides covers both
+        driveSignal.push(uint64_t(std::min(leftStamp, rightStamp)) * 1000, revolutions * M_PI * geometry.driveDiameter);
+    }
+
+    std::int32_t position = vertical.get_position();
+    if (position != PROS_ERR) pushChanged(verticalSignal, now, position / 36000.0f * M_PI * geometry.verticalDiameter);
+    position = horizontal.get_position();
+    if (position != PROS_ERR) pushChanged(horizontalSignal, now, position / 36000.0f * M_PI * geometry.horizontalDiameter);
+    double rotation = imu.get_rotation();
+    if (rotation != PROS_ERR_F) pushChanged(headingSignal, now, rotation * M_PI / 180);
+}
+
+void TimedOdometry::update() {
+    uint64_t now = pros::micros();
+    sample(now);
+    if (horizontalSignal.size() == 0 || headingSignal.size() == 0) return;
+
+    // the vertical wheel counts as gone once it has not reported for 50ms
+    bool fallback = verticalSignal.size() == 0 || now - verticalSignal.latestTime() > 50000;
+    if (fallback && driveSignal.size() == 0) return;
+    TimedSignal<>& forwardSignal = fallback ? driveSignal : verticalSignal;
+
+    // the latest instant every sensor in use has a sample for, so nothing is extrapolated
+    uint64_t common = std::min({forwardSignal.latestTime(), horizontalSignal.latestTime(), headingSignal.latestTime()});
+    // a wheel that has stopped reporting holds its last value rather than extrapolating
+    float verticalNow = verticalSignal.size() == 0 ? 0 : fallback ? verticalSignal.latest() : verticalSignal.at(common);
+    float driveNow = driveSignal.size() > 0 ? driveSignal.at(common) : 0;
+    float horizontalNow = horizontalSignal.at(common), headingNow = headingSignal.at(common);
+
+    mutex.take();
+    stats.horizontal.add(now - horizontalSignal.latestTime());
+    stats.imu.add(now - headingSignal.latestTime());
+    if (verticalSignal.size() > 0) stats.vertical.add(now - verticalSignal.latestTime());
+    if (driveSignal.size() > 0) stats.drive.add(now - driveSignal.latestTime());
+    if (aligned != 0 && common > aligned) {
+        float forward = fallback ? driveNow - lastDrive : verticalNow - lastVertical;
+        // the drive wheels straddle the centre, so their mean has no offset
+        float verticalOffset = fallback ? 0 : geometry.verticalOffset;
+        integrateArc(current, forward, horizontalNow - lastHorizontal, headingNow - lastHeading, verticalOffset,
+                     geometry.horizontalOffset);
+        integrateArc(travelled, forward, horizontalNow - lastHorizontal, headingNow - lastHeading, verticalOffset,
+                     geometry.horizontalOffset);
+        fuse(now, (common - aligned) / 1e6f, forward, horizontalNow - lastHorizontal, headingNow - lastHeading, verticalOffset);
+        history.push({common, {filter.x(), filter.y(), filter.theta()}, filter.vx(), filter.vy(), filter.omega()});
+        if (fallback) stats.fallbacks++;
+    }
+    if (aligned == 0 || common > aligned) {
+        aligned = common;
+        lastVertical = verticalNow;
+        lastDrive = driveNow;
+        lastHorizontal = horizontalNow;
+        lastHeading = headingNow;
+    }
+    PlanarPose pose = {filter.x(), filter.y(), filter.theta()};
+    mutex.give();
+
+    // LemLib's own odometry task still runs, this overwrites its pose with ours every tick
+    if (driveChassis) chassis.setPose(pose.x, pose.y, pose.theta, true);
+}
+
+// Where the filter had the robot `latency` ms before now, the current estimate for a sensor
+// without one or a reading older than the history
+PlanarPose TimedOdometry::estimateBefore(uint64_t now, uint32_t latency) const {
+    PoseSample sample;
+    if (latency > 0 && history.at(now - latency * 1000, sample)) return sample.pose;
+    return {filter.x(), filter.y(), filter.theta()};
+}
+
+// Called with the mutex held, once per aligned step of dt seconds
+void TimedOdometry::fuse(uint64_t now, float dt, float forward, float sideways, float dTheta, float verticalOffset) {
+    uint64_t begin = pros::micros();
+    filter.predict(dt);
+    filter.updateWheels(forward / dt, sideways / dt, verticalOffset, geometry.horizontalOffset);
+    filter.updateGyro(dTheta / dt);
+
+    if (gps != nullptr) {
+        pros::gps_status_s_t status = gps->get_position_and_orientation();
+        // only a new fix is a new measurement
+        if (status.x != lastGps.x || status.y != lastGps.y || status.yaw != lastGps.yaw) {
+            lastGps = status;
+            const float inches = 39.3701f;
+            filter.updateGps(status.x * inches, status.y * inches, status.yaw * M_PI / 180, gps->get_error() * inches,
+                             gpsHeadingError, estimateBefore(now, gpsLatency));
+        }
+    }
+    for (size_t i = 0; i < rangeCount; i++) {
+        RangeSensor& range = rangeSensors[i];
+        std::int32_t mm = range.sensor->get_distance();
+        // 9999 is nothing in range, and an unchanged value is the same sample again
+        if (mm == PROS_ERR || mm >= 9999 || mm == range.last) continue;
+        range.last = mm;
+        if (filter.updateRange(mm / 25.4f, range.mount, estimateBefore(now, range.latency))) stats.ranges++;
+        else stats.rangesRejected++;
+    }
+    stats.filterMaxUs = std::max(stats.filterMaxUs, uint32_t(pros::micros() - begin));
+}
+
+void TimedOdometry::start() {
+    if (task != nullptr) return;
+    // carry on from wherever the chassis was put before the task started
+    lemlib::Pose seed = chassis.getPose(true);
+    setPose({seed.x, seed.y, seed.theta});
+    readSigns(left, leftSigns);
+    readSigns(right, rightSigns);
+    vertical.set_data_rate(5);
+    horizontal.set_data_rate(5);
+    imu.set_data_rate(5);
+    task = new pros::Task([this] {
+        uint32_t wake = pros::millis();
+        uint64_t last = pros::micros();
+        while (true) {
+            pros::Task::delay_until(&wake, period);
+            uint64_t now = pros::micros();
+            mutex.take();
+            stats.jitter.add(now - last, period * 1000);
+            mutex.give();
+            last = now;
+            update();
+        }
+    }, TASK_PRIORITY_MAX, TASK_STACK_DEPTH_DEFAULT, "odometry");
+}
+
+void TimedOdometry::useGps(pros::Gps& sensor, float headingError, uint32_t latency) {
+    gps = &sensor;
+    gpsHeadingError = headingError;
+    gpsLatency = latency;
+}
+
+bool TimedOdometry::addRangeSensor(pros::Distance& sensor, SensorMount mount, uint32_t latency) {
+    if (rangeCount == rangeSensors.size()) return false;
+    rangeSensors[rangeCount++] = {&sensor, mount, -1, latency};
+    return true;
+}
+
+PlanarPose TimedOdometry::pose() {
+    mutex.take();
+    PlanarPose pose = current;
+    mutex.give();
+    return pose;
+}
+
+PlanarPose TimedOdometry::motion() {
+    mutex.take();
+    PlanarPose pose = travelled;
+    mutex.give();
+    return pose;
+}
+
+PlanarPose TimedOdometry::estimate() {
+    mutex.take();
+    PlanarPose pose = {filter.x(), filter.y(), filter.theta()};
+    mutex.give();
+    return pose;
+}
+
+void TimedOdometry::setPose(PlanarPose pose) {
+    mutex.take();
+    current = pose;
+    filter.reset(pose.x, pose.y, pose.theta);
+    // the old estimates would interpolate across the jump
+    history.clear();
+    mutex.give();
+}
+
+void TimedOdometry::shift(float dx, float dy) {
+    mutex.take();
+    current.x += dx;
+    current.y += dy;
+    filter.shift(dx, dy);
+    history.shift(dx, dy);
+    mutex.give();
+}
+
+void setRobotPose(float x, float y, float theta) {
+    chassis.setPose(x, y, theta);
+    odometry.setPose({x, y, float(lemlib::degToRad(theta))});
+}
+
+OdometryTiming TimedOdometry::timing() {
+    mutex.take();
+    OdometryTiming timing = stats;
+    mutex.give();
+    return timing;
+}
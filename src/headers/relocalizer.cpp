@@ -0,0 +1,68 @@
+#include "main.h"
+#include "customs/relocalizer.hpp"
+
+bool Relocalizer::addSensor(pros::Distance& sensor, SensorMount mount) {
+    if (count == CAPACITY) return false;
+    sensors[count++] = {&sensor, mount};
+    return true;
+}
+
+// Reads every sensor and moves the chassis pose by the fix, returns which axes moved
+int Relocalizer::correct(float gain) {
+    SensorMount mounts[CAPACITY];
+    float ranges[CAPACITY];
+    int readings = 0;
+    for (size_t i = 0; i < count; i++) {
+        std::int32_t mm = sensors[i].sensor->get_distance();
+        // 9999 is nothing in range
+        if (mm == PROS_ERR || mm >= 9999) continue;
+        mounts[readings] = sensors[i].mount;
+        ranges[readings++] = mm / 25.4f;
+    }
+    if (readings == 0) return 0;
+
+    mutex.take();
+    lemlib::Pose current = chassis.getPose(true);
+    PlanarPose pose = {current.x, current.y, current.theta};
+    int axes = ::relocalize(pose, mounts, ranges, readings, gain);
+    if (axes != 0) {
+        chassis.setPose(pose.x, pose.y, pose.theta, true);
+        // a nudge, so continuous fixes do not restart the filter every 20ms
+        odometry.shift(pose.x - current.x, pose.y - current.y);
+    }
+    mutex.give();
+    return axes;
+}
+
+int Relocalizer::relocalize() {
+    return correct(1);
+}
+
+int Relocalizer::relocalize(lemlib::Pose fallback) {
+    // the heading is always the fallback's, set first so the readings are placed with it
+    mutex.take();
+    lemlib::Pose pose = chassis.getPose();
+    setRobotPose(pose.x, pose.y, fallback.theta);
+    mutex.give();
+
+    int axes = correct(1);
+    if (axes == 3) return axes;
+    mutex.take();
+    pose = chassis.getPose();
+    if (!(axes & 1)) pose.x = fallback.x;
+    if (!(axes & 2)) pose.y = fallback.y;
+    setRobotPose(pose.x, pose.y, fallback.theta);
+    mutex.give();
+    return axes;
+}
+
+void Relocalizer::continuous(float newGain) {
+    gain = newGain;
+    if (task != nullptr || gain <= 0) return;
+    task = new pros::Task([this] {
+        while (true) {
+            if (gain > 0) correct(gain);
+            pros::delay(20);
+        }
+    }, "relocalizer");
+}
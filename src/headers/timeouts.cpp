@@ -0,0 +1,73 @@
+#include "customs/timeouts.hpp"
+#include <algorithm>
+#include <cstdio>
+#include "pros/misc.hpp"
+#include "lemlib/logger/logger.hpp"
+
+static std::string historyPath(const std::string& routine) { return "/usd/timeouts_" + routine + ".csv"; }
+
+void TimeoutLearner::begin(const char* name) {
+    routine = name;
+    records.clear();
+    index = -1;
+    active = mode != TimeoutMode::OFF && pros::usd::is_installed();
+    if (!active) return;
+
+    // no file yet just means this is the routine's first run
+    FILE* file = std::fopen(historyPath(routine).c_str(), "r");
+    if (file == nullptr) return;
+    MotionRecord record;
+    while (std::fscanf(file, "%d,%d,%d", &record.timeout, &record.runs, &record.longest) == 3) records.push_back(record);
+    std::fclose(file);
+}
+
+int TimeoutLearner::learned(const MotionRecord& record) const {
+    if (record.runs < minRuns) return record.timeout;
+    return std::min(record.timeout, int(record.longest * margin) + padding);
+}
+
+int TimeoutLearner::start(int timeout) {
+    if (!active) return timeout;
+    index++;
+    if (index >= int(records.size())) records.resize(index + 1);
+    MotionRecord& record = records[index];
+    // the routine was edited since this was recorded, whatever was learned no longer applies
+    if (record.timeout != timeout) record = {timeout, 0, 0};
+    return mode == TimeoutMode::APPLY ? learned(record) : timeout;
+}
+
+void TimeoutLearner::finish(int duration, bool early) {
+    if (!active || index < 0) return;
+    MotionRecord& record = records[index];
+    if (early) {
+        record.runs++;
+        record.longest = std::max(record.longest, duration);
+    } else {
+        record.runs = record.longest = 0;
+    }
+}
+
+void TimeoutLearner::save() {
+    if (!active) return;
+    active = false;
+    // motions past the last one run this time were cut from the routine
+    records.resize(index + 1);
+
+    FILE* file = std::fopen(historyPath(routine).c_str(), "w");
+    if (file == nullptr) {
+        lemlib::infoSink()->warn("could not write timeout history for {}", routine);
+        return;
+    }
+    int total = 0, saved = 0;
+    for (size_t i = 0; i < records.size(); i++) {
+        const MotionRecord& record = records[i];
+        std::fprintf(file, "%d,%d,%d\n", record.timeout, record.runs, record.longest);
+        int tightened = learned(record);
+        total += record.timeout;
+        saved += record.timeout - tightened;
+        if (mode == TimeoutMode::PROPOSE && tightened < record.timeout)
+            lemlib::infoSink()->info("{} motion {}: timeout {} could be {} ms", routine, i, record.timeout, tightened);
+    }
+    std::fclose(file);
+    lemlib::infoSink()->info("{} timeouts: {} of {} ms learned away", routine, saved, total);
+}
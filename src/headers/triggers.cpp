@@ -0,0 +1,134 @@
+#include "customs/triggers.hpp"
+#include <cmath>
+
+// distTraveled is protected, naming it through a derived class gives a member pointer
+// the trigger task can read without touching LemLib itself
+struct ChassisProbe : lemlib::Chassis {
+    static float distance(const lemlib::Chassis& chassis) { return chassis.*(&ChassisProbe::distTraveled); }
+};
+
+// Time at which a value moving from `from` to `to` between two ticks crossed `threshold`
+static uint64_t crossing(uint64_t before, uint64_t now, float from, float to, float threshold) {
+    float fraction = std::fmin(std::fmax((threshold - from) / (to - from), 0), 1);
+    return before + uint64_t(fraction * (now - before));
+}
+
+bool Triggers::afterDistance(float dist, Callback callback) {
+    return add({.type = Type::DISTANCE, .value = dist, .callback = std::move(callback)});
+}
+
+void Triggers::afterDistanceOrWait(float dist, Callback callback) {
+    if (afterDistance(dist, callback)) return;
+    chassis.waitUntil(dist);
+    callback();
+}
+
+bool Triggers::afterTime(uint32_t ms, Callback callback) {
+    return add({.type = Type::TIME, .deadline = pros::micros() + uint64_t(ms) * 1000, .callback = std::move(callback)});
+}
+
+bool Triggers::inRegion(float x, float y, float radius, Callback callback) {
+    return add({.type = Type::REGION, .x = x, .y = y, .value = radius, .callback = std::move(callback)});
+}
+
+bool Triggers::whenDone(Callback callback) {
+    return add({.type = Type::DONE, .callback = std::move(callback)});
+}
+
+// Returns false when every slot is armed, the caller has to fall back to waiting itself
+bool Triggers::add(Trigger trigger) {
+    if (task == nullptr) task = new pros::Task([this] { run(); }, TASK_PRIORITY_MAX - 1, TASK_STACK_DEPTH_DEFAULT, "triggers");
+
+    trigger.armed = true;
+    mutex.take();
+    for (Trigger& slot : slots) {
+        if (slot.armed) continue;
+        slot = std::move(trigger);
+        mutex.give();
+        return true;
+    }
+    mutex.give();
+    return false;
+}
+
+void Triggers::clear() {
+    mutex.take();
+    for (Trigger& slot : slots) slot = Trigger();
+    mutex.give();
+}
+
+TriggerLatency Triggers::latency() {
+    mutex.take();
+    TriggerLatency copy = stats;
+    mutex.give();
+    return copy;
+}
+
+void Triggers::run() {
+    std::array<Callback, CAPACITY> fired;
+    std::array<uint64_t, CAPACITY> since;
+    float lastDist = -1;
+    uint64_t lastTime = pros::micros();
+    uint32_t wake = pros::millis();
+
+    while (true) {
+        uint64_t now = pros::micros();
+        float dist = ChassisProbe::distance(chassis);
+        bool moving = chassis.isInMotion() && dist >= 0;
+        // the next motion resets distTraveled, so a drop means the one we were watching ended
+        bool restarted = moving && lastDist >= 0 && dist < lastDist;
+        lemlib::Pose pose = chassis.getPose();
+
+        size_t count = 0;
+        mutex.take();
+        for (Trigger& trigger : slots) {
+            if (!trigger.armed) continue;
+            bool fire = false;
+            uint64_t became = now;
+            switch (trigger.type) {
+                case Type::DISTANCE:
+                    if (!moving || restarted) fire = true;
+                    else if (dist >= trigger.value) {
+                        fire = true;
+                        if (lastDist >= 0) became = crossing(lastTime, now, lastDist, dist, trigger.value);
+                    }
+                    break;
+                case Type::TIME:
+                    fire = now >= trigger.deadline;
+                    became = trigger.deadline;
+                    break;
+                case Type::REGION: {
+                    float d = std::hypot(pose.x - trigger.x, pose.y - trigger.y);
+                    if (d <= trigger.value) {
+                        fire = true;
+                        if (trigger.last > trigger.value) became = crossing(lastTime, now, trigger.last, d, trigger.value);
+                    }
+                    trigger.last = d;
+                    break;
+                }
+                case Type::DONE: fire = !moving || restarted; break;
+            }
+            if (!fire) continue;
+            trigger.armed = false;
+            fired[count] = std::move(trigger.callback);
+            since[count++] = became;
+        }
+        mutex.give();
+
+        // callbacks run outside the lock so they can arm further triggers
+        for (size_t i = 0; i < count; i++) {
+            fired[i]();
+            fired[i] = nullptr;
+            uint32_t us = pros::micros() - since[i];
+            mutex.take();
+            stats.count++;
+            stats.sumUs += us;
+            if (us > stats.maxUs) stats.maxUs = us;
+            mutex.give();
+        }
+
+        lastDist = moving ? dist : -1;
+        lastTime = now;
+        pros::Task::delay_until(&wake, period);
+    }
+}
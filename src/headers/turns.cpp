@@ -0,0 +1,59 @@
+#include "main.h"
+#include "customs/turns.hpp"
+
+// Shared loop for turns and swings. `scale` is how much faster the driven wheels have to
+// spin for the same angular velocity, 2 for a swing pivoting on the far wheels
+static void profiledTurn(float theta, int timeout, ProfiledTurnParams params, bool swing, lemlib::DriveSide lockedSide) {
+    chassis.waitUntilDone();
+
+    float start = chassis.getPose().theta;
+    float delta = lemlib::angleError(theta, start, false, params.direction);
+    float direction = delta < 0 ? -1 : 1;
+    float maxVelocity = params.maxVelocity > 0 ? std::fmin(params.maxVelocity, turnConstants.maxVelocity) : turnConstants.maxVelocity;
+    MotionProfile1D profile(delta, maxVelocity, turnConstants.maxAcceleration, turnConstants.shape);
+    float scale = swing ? 2 : 1;
+
+    pros::MotorGroup* locked = lockedSide == lemlib::DriveSide::LEFT ? drivetrain.leftMotors : drivetrain.rightMotors;
+    auto previousBrake = locked->get_brake_mode();
+    // the locked side gets 0 power every tick, which HOLD turns into holding position
+    if (swing) locked->set_brake_mode_all(pros::E_MOTOR_BRAKE_HOLD);
+
+    SettleDetector settle(angularSettle);
+    float previousError = 0;
+    uint32_t begin = pros::millis();
+    uint32_t wake = begin;
+    while (pros::millis() - begin < uint32_t(timeout)) {
+        float t = (pros::millis() - begin) / 1000.0f;
+        float position, velocity, acceleration;
+        profile.sample(t, position, velocity, acceleration);
+
+        // heading error against where the profile says we should be by now
+        float error = lemlib::angleError(start + direction * position, chassis.getPose().theta, false);
+
+        float feedforward = scale * (turnConstants.kV * velocity + turnConstants.kA * acceleration);
+        // kS pushes along the profile while it moves, then toward the target so the last
+        // degree is not left sitting inside the drivetrain's static friction
+        float push = velocity > 0 ? direction : std::fabs(error) > angularSettle.errorRange / 2 ? (error < 0 ? -1 : 1) : 0;
+        float power = direction * feedforward + turnConstants.kS * push + turnConstants.kP * error +
+                      turnConstants.kD * (error - previousError) / 0.01f;
+        previousError = error;
+        power = std::clamp(power, -127.0f, 127.0f);
+        if (t >= profile.duration() && settle.update(error, power, 10)) break;
+
+        // positive power turns clockwise, left forwards and right backwards
+        if (!swing) chassis.tank(power, -power, true);
+        else if (lockedSide == lemlib::DriveSide::LEFT) chassis.tank(0, -power, true);
+        else chassis.tank(power, 0, true);
+        pros::Task::delay_until(&wake, 10);
+    }
+    chassis.tank(0, 0, true);
+    if (swing) locked->set_brake_mode_all(previousBrake);
+}
+
+void profiledTurnToHeading(float theta, int timeout, ProfiledTurnParams params) {
+    profiledTurn(theta, timeout, params, false, lemlib::DriveSide::LEFT);
+}
+
+void profiledSwingToHeading(float theta, lemlib::DriveSide lockedSide, int timeout, ProfiledTurnParams params) {
+    profiledTurn(theta, timeout, params, true, lockedSide);
+}
@@ -22,6 +22,17 @@ void initialize()
 {
     //pros::lcd::initialize(); // initialize brain screen
     chassis.calibrate(); // calibrate sensors
+    // Ranges off the walls from dist, fused into the timed odometry's filter, with the chassis
+    // run on the filter's estimate instead of LemLib's wheels-only pose, and the relocalizer's
+    // on-demand fixes using it so skills drops its wall-ram resets. Turn on once distMount in
+    // drivetrain.cpp is measured, a wrong mount pulls the pose off by the error
+    const bool wallSensing = false;
+    if (wallSensing) {
+        odometry.addRangeSensor(dist, distMount);
+        odometry.driveChassis = true;
+        relocalizer.addSensor(dist, distMount);
+    }
+    odometry.start();
     
     /* pros::Task screenTask([&]() {
         while (true) {
@@ -49,10 +60,14 @@ void autonomous()
 {
     selector.run_auton();
     //skills();
+    //trajectoryTest(); // bench run for compiled trajectories, kept out of the selector
 }
 
 void opcontrol()
 {
+    // an auton cut short by the field switch can leave commands queued
+    motions.clear();
+    triggers.clear();
 
     while (true)
     {
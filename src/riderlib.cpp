@@ -1,14 +1,47 @@
+// Trajectory planner and RAMSETE executor, plus the host tool around them. PROS builds every
+// source under src, so the planning core compiles for the brain too, but nothing there calls
+// it: the robot plays assets compiled here through followTrajectory. Everything that needs
+// threads, files, a wall clock or a command line (sweeps, benchmarks, the real-time loop,
+// the asset compiler and main) is host-only.
 #include <iostream>
 #include <vector>
 #include <cmath>
+#include <chrono>
+#include <cstring>
+#include <cstdlib>
+#include <algorithm>
+#include <cstdint>
 #include "Eigen/Dense"
+#include "Eigen/SparseCore"
+#include "Eigen/SparseLU"
+#ifdef __arm__
+#include "pros/misc.hpp" // V5 brain build
+#else
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <atomic>
+#include <tuple>
+#include <random>
+#include "customs/trajectory.hpp"
+#include "customs/path.hpp"
+#include "customs/bezier.hpp"
+#include "customs/profile.hpp"
+#include "customs/settle.hpp"
+#include "customs/boomerang.hpp"
+#include "customs/timesync.hpp"
+#include "customs/ekf.hpp"
+#include "customs/relocalize.hpp"
+#include "customs/mcl.hpp"
+#endif
 
 struct Pose {
     double x, y, theta;
 };
 
 struct MotionProfile {
-    double x, y, theta, vx, vy, omega;
+    double x, y, theta, vx, vy, omega, ax, ay, alpha;
 };
 
 struct WheelSpeeds {
@@ -20,8 +53,13 @@ struct QuinticCoeffs {
     double a0, a1, a2, a3, a4, a5;
 };
 
-// Solve for quintic polynomial coefficients
-QuinticCoeffs computeQuinticSpline(double p0, double v0, double a0, double pf, double vf, double af, double tf) {
+// Quintic coefficients for all three axes of one segment
+struct SegmentCoeffs {
+    QuinticCoeffs x, y, theta;
+};
+
+// Solve for quintic polynomial coefficients (reference QR solve, kept for benchmarking)
+QuinticCoeffs computeQuinticSplineQR(double p0, double v0, double a0, double pf, double vf, double af, double tf) {
     Eigen::Matrix<double, 6, 6> T;
     Eigen::Matrix<double, 6, 1> B, X;
 
@@ -38,6 +76,39 @@ QuinticCoeffs computeQuinticSpline(double p0, double v0, double a0, double pf, d
     return {X(0), X(1), X(2), X(3), X(4), X(5)};
 }
 
+// Solve for quintic polynomial coefficients using the closed-form inverse of the
+// boundary-condition matrix. The first three coefficients come straight from the
+// start state, the last three from the end state relative to it.
+QuinticCoeffs computeQuinticSpline(double p0, double v0, double a0, double pf, double vf, double af, double tf) {
+    double t2 = tf * tf, t3 = t2 * tf, t4 = t3 * tf, t5 = t4 * tf;
+    double h = pf - p0;
+
+    return {p0, v0, a0 / 2,
+            (20 * h - (8 * vf + 12 * v0) * tf - (3 * a0 - af) * t2) / (2 * t3),
+            (-30 * h + (14 * vf + 16 * v0) * tf + (3 * a0 - 2 * af) * t2) / (2 * t4),
+            (12 * h - 6 * (vf + v0) * tf + (af - a0) * t2) / (2 * t5)};
+}
+
+// Solve x, y and theta of a segment at once. Each Pose carries one boundary value
+// per axis, so the closed form is applied to all three lanes together.
+SegmentCoeffs computeQuinticSegment(Pose p0, Pose v0, Pose a0, Pose pf, Pose vf, Pose af, double tf) {
+    auto lanes = [](const Pose& p) { return Eigen::Array3d(p.x, p.y, p.theta); };
+    Eigen::Array3d P0 = lanes(p0), V0 = lanes(v0), A0 = lanes(a0);
+    Eigen::Array3d H = lanes(pf) - P0, VF = lanes(vf), AF = lanes(af);
+
+    double t2 = tf * tf, t3 = t2 * tf, t4 = t3 * tf, t5 = t4 * tf;
+    Eigen::Array3d c3 = (20 * H - (8 * VF + 12 * V0) * tf - (3 * A0 - AF) * t2) / (2 * t3);
+    Eigen::Array3d c4 = (-30 * H + (14 * VF + 16 * V0) * tf + (3 * A0 - 2 * AF) * t2) / (2 * t4);
+    Eigen::Array3d c5 = (12 * H - 6 * (VF + V0) * tf + (AF - A0) * t2) / (2 * t5);
+
+    SegmentCoeffs out;
+    QuinticCoeffs* axes[3] = {&out.x, &out.y, &out.theta};
+    for (int k = 0; k < 3; ++k) {
+        *axes[k] = {P0(k), V0(k), A0(k) / 2, c3(k), c4(k), c5(k)};
+    }
+    return out;
+}
+
 // Evaluate position, velocity, acceleration
 void evaluateQuintic(QuinticCoeffs c, double t, double& pos, double& vel, double& acc) {
     pos = c.a0 + c.a1*t + c.a2*t*t + c.a3*t*t*t + c.a4*t*t*t*t + c.a5*t*t*t*t*t;
@@ -45,6 +116,15 @@ void evaluateQuintic(QuinticCoeffs c, double t, double& pos, double& vel, double
     acc = 2*c.a2 + 6*c.a3*t + 12*c.a4*t*t + 20*c.a5*t*t*t;
 }
 
+// Setpoint of a segment at time t
+MotionProfile evaluateSegment(const SegmentCoeffs& c, double t) {
+    MotionProfile p;
+    evaluateQuintic(c.x, t, p.x, p.vx, p.ax);
+    evaluateQuintic(c.y, t, p.y, p.vy, p.ay);
+    evaluateQuintic(c.theta, t, p.theta, p.omega, p.alpha);
+    return p;
+}
+
 // Generate a motion profile
 std::vector<MotionProfile> generateMotionProfile(QuinticCoeffs xC, QuinticCoeffs yC, QuinticCoeffs thetaC, double tf, int steps) {
     std::vector<MotionProfile> profile;
@@ -56,26 +136,183 @@ std::vector<MotionProfile> generateMotionProfile(QuinticCoeffs xC, QuinticCoeffs
         evaluateQuintic(yC, t, y, vy, ay);
         evaluateQuintic(thetaC, t, theta, omega, alpha);
 
-        profile.push_back({x, y, theta, vx, vy, omega});
+        profile.push_back({x, y, theta, vx, vy, omega, ax, ay, alpha});
     }
     return profile;
 }
 
+// Structure-of-arrays motion profile, reused between samplings so it only allocates when it grows
+struct ProfileBuffer {
+    std::vector<float> x, y, theta, vx, vy, omega, ax, ay, alpha;
+
+    void resize(size_t points) {
+        for (auto* column : {&x, &y, &theta, &vx, &vy, &omega, &ax, &ay, &alpha}) column->resize(points);
+    }
+
+    size_t size() const { return x.size(); }
+
+    MotionProfile operator[](size_t i) const {
+        return {x[i], y[i], theta[i], vx[i], vy[i], omega[i], ax[i], ay[i], alpha[i]};
+    }
+};
+
+// Segment coefficients packed into SIMD lanes (x, y, theta, unused) so one Eigen
+// packet evaluates all three axes. Maps to SSE on the host and NEON on the brain.
+struct SegmentLanes {
+    Eigen::Array4f pos[6];
+    Eigen::Array4f vel[5];
+    Eigen::Array4f acc[4];
+};
+
+SegmentLanes packSegment(const SegmentCoeffs& c) {
+    SegmentLanes lanes;
+    const double* axes[3] = {&c.x.a0, &c.y.a0, &c.theta.a0};
+    for (int k = 0; k < 6; ++k) {
+        lanes.pos[k] = Eigen::Array4f(axes[0][k], axes[1][k], axes[2][k], 0);
+    }
+    for (int k = 0; k < 5; ++k) {
+        lanes.vel[k] = lanes.pos[k + 1] * float(k + 1);
+    }
+    for (int k = 0; k < 4; ++k) {
+        lanes.acc[k] = lanes.vel[k + 1] * float(k + 1);
+    }
+    return lanes;
+}
+
+// Evaluate position, velocity and acceleration of all three axes in Horner form
+inline void evaluateLanes(const SegmentLanes& lanes, float t, Eigen::Array4f& pos, Eigen::Array4f& vel, Eigen::Array4f& acc) {
+    pos = lanes.pos[5];
+    for (int k = 4; k >= 0; --k) pos = pos * t + lanes.pos[k];
+    vel = lanes.vel[4];
+    for (int k = 3; k >= 0; --k) vel = vel * t + lanes.vel[k];
+    acc = lanes.acc[3];
+    for (int k = 2; k >= 0; --k) acc = acc * t + lanes.acc[k];
+}
+
+// Sample a segment into a SoA buffer, evaluating position and velocity in Horner form
+void sampleMotionProfile(const SegmentCoeffs& c, double tf, int steps, ProfileBuffer& out) {
+    const SegmentLanes lanes = packSegment(c);
+    const float dt = tf / steps;
+    out.resize(steps + 1);
+
+    for (int i = 0; i <= steps; ++i) {
+        Eigen::Array4f pos, vel, acc;
+        evaluateLanes(lanes, dt * i, pos, vel, acc);
+
+        out.x[i] = pos[0];
+        out.y[i] = pos[1];
+        out.theta[i] = pos[2];
+        out.vx[i] = vel[0];
+        out.vy[i] = vel[1];
+        out.omega[i] = vel[2];
+        out.ax[i] = acc[0];
+        out.ay[i] = acc[1];
+        out.alpha[i] = acc[2];
+    }
+}
+
 // Convert velocity to wheel speeds
 WheelSpeeds tankDriveWheelSpeeds(double v, double omega, double track_width) {
     return { v - (omega * track_width / 2), v + (omega * track_width / 2) };
 }
 
+// What a setpoint asks of the robot: where to be, its forward speed and acceleration along
+// the path, and its turn rate and angular acceleration. RAMSETE and both feedforward terms
+// read from this, so they describe the same motion.
+struct PathReference {
+    Pose pose;
+    double v, a, omega, alpha;
+};
+
+// Below this path speed the tangent is too short to trust, m/s
+constexpr double REST_SPEED = 1e-3;
+
+// A differential drive only moves along its heading, so the heading a setpoint asks for is
+// the path's tangent and the turn rate is how fast the tangent swings, not the spline's
+// theta channel. Where the path stands still the theta channel counts only while it turns
+// the robot in place, carrying on from the held heading; a moving segment that comes to
+// rest with its channel somewhere else holds the heading where it was. `previous` is the
+// reference one step of dt earlier, which unwraps the heading and differentiates the turn rate.
+PathReference pathReference(const MotionProfile& p, const PathReference& previous, double dt) {
+    double v = std::hypot(p.vx, p.vy);
+    if (v > REST_SPEED) {
+        double heading = previous.pose.theta + std::remainder(std::atan2(p.vy, p.vx) - previous.pose.theta, 2 * M_PI);
+        double omega = (p.vx * p.ay - p.vy * p.ax) / (v * v);
+        // Tangential acceleration is the rate of change of path speed
+        return {{p.x, p.y, heading}, v, (p.vx * p.ax + p.vy * p.ay) / v, omega, (omega - previous.omega) / dt};
+    }
+    double step = std::remainder(p.theta - previous.pose.theta, 2 * M_PI);
+    double reach = (std::abs(p.omega) + std::abs(previous.omega)) * dt + std::abs(p.alpha) * dt * dt + 1e-6;
+    bool turning = (std::abs(p.omega) > 1e-9 || std::abs(p.alpha) > 1e-9) && std::abs(step) <= reach;
+    double heading = turning ? previous.pose.theta + step : previous.pose.theta;
+    double a = p.ax * std::cos(heading) + p.ay * std::sin(heading);
+    return turning ? PathReference{{p.x, p.y, heading}, 0, a, p.omega, p.alpha} : PathReference{{p.x, p.y, heading}, 0, a, 0, 0};
+}
+
+// Reference at the start of a segment, where there is no earlier setpoint: the heading is
+// the way the path sets off, and the turn rate is differentiated a small step ahead
+PathReference startReference(const SegmentCoeffs& c, double tf) {
+    const double h = tf * 1e-4;
+    MotionProfile p0 = evaluateSegment(c, 0), p1 = evaluateSegment(c, h);
+    double moved = std::hypot(p1.x - p0.x, p1.y - p0.y);
+    PathReference seed = {{p0.x, p0.y, moved > 1e-12 ? std::atan2(p1.y - p0.y, p1.x - p0.x) : p0.theta}, 0, 0, 0, 0};
+    PathReference start = pathReference(p0, seed, h);
+    if (start.v > 0) start.alpha = pathReference(p1, start, h).alpha;
+    return start;
+}
+
+// Drivetrain limits used to time a segment
+struct DriveLimits {
+    double maxWheelVelocity; // Wheel speed at 12V, m/s
+    double maxWheelAcceleration; // m/s^2
+};
+
+// Peak wheel velocity and acceleration over a segment
+struct SegmentPeaks {
+    double velocity, acceleration;
+};
+
+// Sample a segment and find the largest wheel velocity and acceleration either side sees
+SegmentPeaks segmentPeaks(const SegmentCoeffs& c, double tf, double track_width, int samples = 200) {
+    SegmentPeaks peaks = {0, 0};
+    PathReference ref = startReference(c, tf);
+    for (int i = 0; i <= samples; ++i) {
+        if (i > 0) ref = pathReference(evaluateSegment(c, (tf / samples) * i), ref, tf / samples);
+
+        WheelSpeeds speeds = tankDriveWheelSpeeds(ref.v, ref.omega, track_width);
+        WheelSpeeds accels = tankDriveWheelSpeeds(ref.a, ref.alpha, track_width);
+        peaks.velocity = std::max({peaks.velocity, std::abs(speeds.left), std::abs(speeds.right)});
+        peaks.acceleration = std::max({peaks.acceleration, std::abs(accels.left), std::abs(accels.right)});
+    }
+    return peaks;
+}
+
+// How far a segment is over its limits; below 1 means it could run faster
+double segmentLoad(const SegmentCoeffs& c, double tf, double maxVoltage, DriveLimits limits, double track_width) {
+    SegmentPeaks peaks = segmentPeaks(c, tf, track_width);
+    double maxVelocity = limits.maxWheelVelocity * std::min(maxVoltage, 12.0) / 12;
+    return std::max(peaks.velocity / maxVelocity, std::sqrt(peaks.acceleration / limits.maxWheelAcceleration));
+}
+
+// Find the shortest feasible duration for a rest-to-rest segment. The spline's shape does
+// not depend on tf, so wheel velocities scale with 1/tf and accelerations with 1/tf^2:
+// the load of the segment solved in unit time is exactly the duration it needs.
+double computeSegmentTime(Pose start, Pose end, double maxVoltage, DriveLimits limits, double track_width) {
+    Pose rest = {0, 0, 0};
+    SegmentCoeffs unit = computeQuinticSegment(start, rest, rest, end, rest, rest, 1.0);
+    return segmentLoad(unit, 1.0, maxVoltage, limits, track_width);
+}
+
 // RAMSETE Controller
-WheelSpeeds ramseteControl(Pose robotPose, MotionProfile target, double b, double zeta, double track_width) {
-    double ex = cos(robotPose.theta) * (target.x - robotPose.x) + sin(robotPose.theta) * (target.y - robotPose.y);
-    double ey = -sin(robotPose.theta) * (target.x - robotPose.x) + cos(robotPose.theta) * (target.y - robotPose.y);
-    double etheta = target.theta - robotPose.theta;
+WheelSpeeds ramseteControl(Pose robotPose, const PathReference& target, double b, double zeta, double track_width) {
+    double ex = cos(robotPose.theta) * (target.pose.x - robotPose.x) + sin(robotPose.theta) * (target.pose.y - robotPose.y);
+    double ey = -sin(robotPose.theta) * (target.pose.x - robotPose.x) + cos(robotPose.theta) * (target.pose.y - robotPose.y);
+    double etheta = std::remainder(target.pose.theta - robotPose.theta, 2 * M_PI);
 
-    double k1 = 2 * zeta * sqrt(target.omega * target.omega + b * target.vx * target.vx);
-    double k3 = b * target.vx;
+    double k1 = 2 * zeta * sqrt(target.omega * target.omega + b * target.v * target.v);
+    double k3 = b * target.v;
 
-    double v = target.vx * cos(etheta) + k1 * ex;
+    double v = target.v * cos(etheta) + k1 * ex;
     double omega = target.omega + k3 * ey + k1 * etheta;
 
     return tankDriveWheelSpeeds(v, omega, track_width);
@@ -86,71 +323,1808 @@ double clampVoltage(double voltage, double maxVoltage) {
     return std::max(-maxVoltage, std::min(voltage, maxVoltage));
 }
 
-// Update odometry
-Pose updateOdometry(double v_left, double v_right, double track_width, double dt) {
-    static Pose pose = {0, 0, 0};
-    double v = (v_left + v_right) / 2;
-    double omega = (v_right - v_left) / track_width;
+// Feedforward model of one drive side: static, velocity and acceleration terms
+struct MotorModel {
+    double kS; // Volts to overcome friction
+    double kV; // Volts per m/s
+    double kA; // Volts per m/s^2
+};
 
-    pose.x += v * cos(pose.theta) * dt;
-    pose.y += v * sin(pose.theta) * dt;
-    pose.theta += omega * dt;
+struct DriveModel {
+    MotorModel left, right;
+};
 
-    return pose;
+// Voltage a side needs to hold a wheel velocity and acceleration. kS is left out near
+// zero speed so it does not chatter between signs while holding still.
+double feedforwardVoltage(const MotorModel& model, double velocity, double acceleration) {
+    double sign = std::abs(velocity) < 1e-3 ? 0 : velocity > 0 ? 1 : -1;
+    return model.kS * sign + model.kV * velocity + model.kA * acceleration;
 }
 
+// Wheel accelerations the profile asks for, from its tangential and angular accelerations
+WheelSpeeds profileWheelAccelerations(const PathReference& target, double track_width) {
+    return tankDriveWheelSpeeds(target.a, target.alpha, track_width);
+}
+
+// Turn a desired voltage into a motor command. Commands are a fraction of the 12V scale
+// applied to whatever the battery really holds, so scale up by 12 / battery and cap the
+// command so the voltage the motor actually sees stays within maxVoltage.
+double commandVoltage(double voltage, double maxVoltage, double batteryVoltage) {
+    double scale = 12.0 / batteryVoltage;
+    return clampVoltage(voltage * scale, std::min(maxVoltage * scale, 12.0));
+}
+
+// Read battery voltage, nominal on the host
+#ifdef __arm__
+double readBatteryVoltage() {
+    return pros::battery::get_voltage() / 1000.0;
+}
+#else
+double readBatteryVoltage() {
+    return 12.0;
+}
+#endif
+
+// Odometry state for one robot, so several can be integrated side by side
+struct Odometry {
+    Pose pose = {0, 0, 0};
+
+    // Update odometry
+    Pose update(double v_left, double v_right, double track_width, double dt) {
+        double v = (v_left + v_right) / 2;
+        double omega = (v_right - v_left) / track_width;
+
+        pose.x += v * cos(pose.theta) * dt;
+        pose.y += v * sin(pose.theta) * dt;
+        pose.theta += omega * dt;
+
+        return pose;
+    }
+};
+
 // Set motor voltage
 void setMotorVoltage(double left_voltage, double right_voltage) {
     std::cout << "Left Voltage: " << left_voltage << "V, Right Voltage: " << right_voltage << "V\n";
 }
 
-// Execute motion profile with voltage limits
-void executePath(std::vector<std::vector<MotionProfile>> waypoints, std::vector<double> maxVoltages, double track_width, double dt) {
-    Pose robotPose = {0, 0, 0};
+// Host stand-in for the drivetrain: prints the voltages and assumes the wheels reach the commanded speeds
+struct PrintDrive {
+    double battery() const { return readBatteryVoltage(); }
+
+    WheelSpeeds apply(double left_voltage, double right_voltage, WheelSpeeds commanded, double) {
+        setMotorVoltage(left_voltage, right_voltage);
+        return commanded;
+    }
+};
+
+// Advance one side's wheel velocity under an applied voltage by inverting its motor model
+double stepMotor(const MotorModel& model, double velocity, double voltage, double dt) {
+    // Stiction holds the wheel until the voltage beats kS
+    if (std::abs(velocity) < 1e-3 && std::abs(voltage) <= model.kS) return 0;
+
+    double sign = std::abs(velocity) < 1e-3 ? (voltage > 0 ? 1 : -1) : velocity > 0 ? 1 : -1;
+    double acceleration = (voltage - model.kS * sign - model.kV * velocity) / model.kA;
+    return velocity + acceleration * dt;
+}
+
+// Simulated drivetrain whose wheels follow a motor model, which may differ from the one
+// the controller feeds forward with
+struct SimulatedDrive {
+    DriveModel plant;
+    double batteryVoltage = 12.0;
+    WheelSpeeds wheels = {0, 0};
+
+    double battery() const { return batteryVoltage; }
+
+    WheelSpeeds apply(double left_voltage, double right_voltage, WheelSpeeds, double dt) {
+        wheels.left = stepMotor(plant.left, wheels.left, left_voltage * batteryVoltage / 12, dt);
+        wheels.right = stepMotor(plant.right, wheels.right, right_voltage * batteryVoltage / 12, dt);
+        return wheels;
+    }
+};
+
+// A timed segment of the path, sampled at steps + 1 evenly spaced setpoints
+struct TrajectorySegment {
+    SegmentCoeffs coeffs;
+    double tf;
+    int steps;
+    size_t leg = 0; // Waypoint leg the segment drives, which picks its voltage cap
+};
+
+// Walks a list of segments one control tick at a time, evaluating each setpoint from the
+// spline coefficients on demand. Only the packed lanes of the current segment are kept,
+// so nothing is allocated per tick and the sampled trajectory never exists in memory.
+// A segment's first setpoint is the last one's end, so it is only visited once.
+class TrajectoryIterator {
+public:
+    explicit TrajectoryIterator(const std::vector<TrajectorySegment>& segments) : segments(segments) { load(0); }
+
+    bool done() const { return segment >= segments.size(); }
+    size_t segmentIndex() const { return segment; }
+    size_t leg() const { return segments[segment].leg; }
+
+    MotionProfile operator*() const {
+        const TrajectorySegment& current = segments[segment];
+        Eigen::Array4f pos, vel, acc;
+        evaluateLanes(lanes, (current.tf / current.steps) * step, pos, vel, acc);
+        return {pos[0], pos[1], pos[2], vel[0], vel[1], vel[2], acc[0], acc[1], acc[2]};
+    }
+
+    TrajectoryIterator& operator++() {
+        if (++step > segments[segment].steps) load(segment + 1);
+        return *this;
+    }
+
+private:
+    void load(size_t index) {
+        segment = index;
+        step = index == 0 ? 0 : 1;
+        if (!done()) lanes = packSegment(segments[segment].coeffs);
+    }
+
+    const std::vector<TrajectorySegment>& segments;
+    size_t segment = 0;
+    int step = 0;
+    SegmentLanes lanes;
+};
+
+// Per-iteration timing of a periodic loop. Period error is how far the real time between
+// wake-ups strayed from the nominal period; latency is the compute time after waking.
+struct LoopStats {
+    int ticks = 0, overruns = 0;
+    double sumPeriodError = 0, maxPeriodError = 0;
+    double sumLatency = 0, maxLatency = 0;
+
+    void record(double period, double nominal, double latency) {
+        double periodError = std::abs(period - nominal);
+        ++ticks;
+        sumPeriodError += periodError;
+        maxPeriodError = std::max(maxPeriodError, periodError);
+        sumLatency += latency;
+        maxLatency = std::max(maxLatency, latency);
+        if (latency > nominal) ++overruns;
+    }
+
+    void print(double nominal) const {
+        if (ticks == 0) return;
+        std::cout << "Loop " << nominal * 1000 << "ms x" << ticks << ": latency mean " << sumLatency / ticks * 1000
+                  << "ms max " << maxLatency * 1000 << "ms, jitter mean " << sumPeriodError / ticks * 1000 << "ms max "
+                  << maxPeriodError * 1000 << "ms, " << overruns << " overruns\n";
+    }
+};
+
+// Loop that runs on a virtual clock, for simulation and printing where real time does not matter
+struct SimulatedLoop {
+    double period;
+
+    double next() { return period; }
+    void finish() {}
+};
+
+// Fixed-rate loop against absolute deadlines, so compute time does not push the schedule
+// back. next() sleeps until the next deadline and returns the real time since the last
+// wake-up; finish() records how long the iteration's work took. Host only, for --realtime;
+// on the robot followTrajectory keeps its own delay_until schedule.
+#ifndef __arm__
+class PeriodicLoop {
+public:
+    explicit PeriodicLoop(double period) : period(period) {}
+
+    double next() {
+        auto now = std::chrono::steady_clock::now();
+        if (ticks++ == 0) {
+            deadline = now;
+        } else {
+            deadline += std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(period));
+            std::this_thread::sleep_until(deadline);
+            now = std::chrono::steady_clock::now();
+        }
+        lastPeriod = ticks == 1 ? period : std::chrono::duration<double>(now - lastWake).count();
+        lastWake = now;
+        return lastPeriod;
+    }
+
+    void finish() {
+        double latency = std::chrono::duration<double>(std::chrono::steady_clock::now() - lastWake).count();
+        if (ticks > 1) stats.record(lastPeriod, period, latency);
+    }
+
+    const LoopStats& statistics() const { return stats; }
+
+private:
+    double period;
+    double lastPeriod = 0;
+    int ticks = 0;
+    LoopStats stats;
+    std::chrono::steady_clock::time_point deadline, lastWake;
+};
+#endif
+
+// RAMSETE tuning gains
+struct RamseteGains {
+    double b, zeta;
+};
+
+// How closely a run followed its path
+struct PathResult {
+    double rmsError, maxError, finalError; // Position error, meters
+    Pose finalPose;
+};
+
+// Execute motion profile with voltage limits, one setpoint per loop tick. Odometry
+// integrates the last measured wheel speeds over the time that really passed, as reported
+// by the loop. All state lives in this call, so separate runs are independent and can
+// execute in parallel with their own Drive and Loop.
+template <typename Drive, typename Loop>
+PathResult executePath(const std::vector<TrajectorySegment>& segments, const std::vector<double>& maxVoltages,
+                       const DriveModel& model, RamseteGains gains, double track_width, Drive& drive, Loop& loop) {
+    if (segments.empty()) return {0, 0, 0, {0, 0, 0}};
+    // The robot starts on the path, facing the way it sets off
+    PathReference target = startReference(segments[0].coeffs, segments[0].tf);
+    Odometry odometry;
+    odometry.pose = target.pose;
+    WheelSpeeds measured = {0, 0};
+    double sumSquared = 0, maxError = 0, error = 0;
+    int ticks = 0;
+
+    for (TrajectoryIterator it(segments); !it.done(); ++it, ++ticks) {
+        double elapsed = loop.next();
+        odometry.update(measured.left, measured.right, track_width, elapsed);
+
+        const TrajectorySegment& segment = segments[it.segmentIndex()];
+        if (ticks > 0) target = pathReference(*it, target, segment.tf / segment.steps);
+        double maxVoltage = maxVoltages[it.leg()];
+
+        error = std::hypot(target.pose.x - odometry.pose.x, target.pose.y - odometry.pose.y);
+        sumSquared += error * error;
+        maxError = std::max(maxError, error);
+
+        WheelSpeeds speeds = ramseteControl(odometry.pose, target, gains.b, gains.zeta, track_width);
+        WheelSpeeds accels = profileWheelAccelerations(target, track_width);
+
+        // Feedforward on the corrected wheel speeds, then compensate for the battery and clamp
+        double battery = drive.battery();
+        double left_voltage = commandVoltage(feedforwardVoltage(model.left, speeds.left, accels.left), maxVoltage, battery);
+        double right_voltage = commandVoltage(feedforwardVoltage(model.right, speeds.right, accels.right), maxVoltage, battery);
+
+        measured = drive.apply(left_voltage, right_voltage, speeds, elapsed);
+        loop.finish();
+    }
+
+    return {ticks > 0 ? std::sqrt(sumSquared / ticks) : 0, maxError, error, odometry.pose};
+}
+
+#ifndef __arm__
+// One rollout of a gain and voltage-cap sweep
+struct SweepCase {
+    RamseteGains gains;
+    double voltageScale; // Multiplies every segment's maxVoltage
+    PathResult result;
+};
+
+// Run every case against a simulated drivetrain, spreading rollouts over all cores
+void runSweep(std::vector<SweepCase>& cases, const std::vector<TrajectorySegment>& segments, const std::vector<double>& maxVoltages,
+              const DriveModel& model, const DriveModel& plant, double track_width, double dt) {
+    std::atomic<size_t> next = 0;
+    auto worker = [&]() {
+        std::vector<double> scaled(maxVoltages.size());
+        for (size_t i = next++; i < cases.size(); i = next++) {
+            SweepCase& c = cases[i];
+            for (size_t k = 0; k < maxVoltages.size(); ++k) scaled[k] = maxVoltages[k] * c.voltageScale;
+
+            SimulatedDrive drive = {plant};
+            SimulatedLoop loop = {dt};
+            c.result = executePath(segments, scaled, model, c.gains, track_width, drive, loop);
+        }
+    };
+
+    std::vector<std::thread> threads;
+    unsigned count = std::max(1u, std::thread::hardware_concurrency());
+    for (unsigned t = 0; t < count; ++t) threads.emplace_back(worker);
+    for (std::thread& thread : threads) thread.join();
+}
 
+#endif
+
+// Jerk and snap at both ends of a segment, as linear functions of its boundary values
+// (p0, v0, a0, pf, vf, af). Rows are start jerk, start snap, end jerk, end snap.
+Eigen::Matrix<double, 4, 6> endDerivativeRows(double tf) {
+    Eigen::Matrix<double, 4, 6> rows;
+    for (int k = 0; k < 6; ++k) {
+        double b[6] = {0, 0, 0, 0, 0, 0};
+        b[k] = 1;
+        QuinticCoeffs c = computeQuinticSpline(b[0], b[1], b[2], b[3], b[4], b[5], tf);
+        rows(0, k) = 6 * c.a3;
+        rows(1, k) = 24 * c.a4;
+        rows(2, k) = 6 * c.a3 + 24 * c.a4 * tf + 60 * c.a5 * tf * tf;
+        rows(3, k) = 24 * c.a4 + 120 * c.a5 * tf;
+    }
+    return rows;
+}
+
+// Solve one quintic spline through all waypoints, starting and ending at rest. The
+// velocity and acceleration at each interior waypoint are unknowns shared by the two
+// segments that meet there; requiring matching jerk and snap across the joint gives two
+// equations per waypoint. The system is banded, so it is solved with SparseLU for all
+// three axes at once.
+std::vector<SegmentCoeffs> solveContinuousSpline(const std::vector<Pose>& waypoints, const std::vector<double>& durations) {
+    const int segments = int(waypoints.size()) - 1;
+    const int interior = segments - 1;
+
+    Eigen::MatrixX3d positions(waypoints.size(), 3);
     for (size_t i = 0; i < waypoints.size(); ++i) {
-        auto profile = waypoints[i];
-        double maxVoltage = maxVoltages[i];
+        positions.row(i) << waypoints[i].x, waypoints[i].y, waypoints[i].theta;
+    }
+
+    // Velocity and acceleration of every waypoint; the ends stay at rest
+    Eigen::MatrixX3d velocities = Eigen::MatrixX3d::Zero(waypoints.size(), 3);
+    Eigen::MatrixX3d accelerations = Eigen::MatrixX3d::Zero(waypoints.size(), 3);
+
+    if (interior > 0) {
+        std::vector<Eigen::Triplet<double>> triplets;
+        triplets.reserve(interior * 2 * 6);
+        Eigen::MatrixX3d rhs = Eigen::MatrixX3d::Zero(interior * 2, 3);
+
+        // Add coeff * (slot of waypoint) to an equation; slot 0 is position, 1 velocity, 2 acceleration
+        auto add = [&](int eq, int waypoint, int slot, double coeff) {
+            if (slot == 0) {
+                rhs.row(eq) -= coeff * positions.row(waypoint);
+            } else if (waypoint > 0 && waypoint < segments) {
+                triplets.emplace_back(eq, 2 * (waypoint - 1) + slot - 1, coeff);
+            }
+        };
+
+        Eigen::Matrix<double, 4, 6> left = endDerivativeRows(durations[0]);
+        for (int j = 1; j <= interior; ++j) {
+            Eigen::Matrix<double, 4, 6> right = endDerivativeRows(durations[j]);
+            for (int d = 0; d < 2; ++d) {
+                int eq = 2 * (j - 1) + d;
+                for (int k = 0; k < 6; ++k) {
+                    add(eq, j - 1 + k / 3, k % 3, left(2 + d, k));
+                    add(eq, j + k / 3, k % 3, -right(d, k));
+                }
+            }
+            left = right;
+        }
+
+        Eigen::SparseMatrix<double> A(interior * 2, interior * 2);
+        A.setFromTriplets(triplets.begin(), triplets.end());
+
+        Eigen::SparseLU<Eigen::SparseMatrix<double>> solver;
+        solver.compute(A);
+        if (solver.info() != Eigen::Success) {
+            std::cerr << "Continuous spline solve failed\n";
+            return {};
+        }
+        Eigen::MatrixX3d X = solver.solve(rhs);
+
+        for (int j = 1; j <= interior; ++j) {
+            velocities.row(j) = X.row(2 * (j - 1));
+            accelerations.row(j) = X.row(2 * (j - 1) + 1);
+        }
+    }
+
+    auto pose = [](const Eigen::MatrixX3d& m, int row) { return Pose{m(row, 0), m(row, 1), m(row, 2)}; };
+    std::vector<SegmentCoeffs> coeffs;
+    coeffs.reserve(segments);
+    for (int i = 0; i < segments; ++i) {
+        coeffs.push_back(computeQuinticSegment(pose(positions, i), pose(velocities, i), pose(accelerations, i),
+                                               pose(positions, i + 1), pose(velocities, i + 1),
+                                               pose(accelerations, i + 1), durations[i]));
+    }
+    return coeffs;
+}
+
+// Round segment durations up to whole control periods and solve the continuous spline for them
+std::vector<TrajectorySegment> timedSegments(const std::vector<Pose>& waypoints, std::vector<double> durations, double dt) {
+    std::vector<int> steps(durations.size());
+    for (size_t i = 0; i < durations.size(); ++i) {
+        steps[i] = std::max(1, int(std::ceil(durations[i] / dt)));
+        durations[i] = steps[i] * dt;
+    }
+    std::vector<SegmentCoeffs> coeffs = solveContinuousSpline(waypoints, durations);
+
+    std::vector<TrajectorySegment> segments;
+    segments.reserve(coeffs.size());
+    for (size_t i = 0; i < coeffs.size(); ++i) {
+        segments.push_back({coeffs[i], durations[i], steps[i], i});
+    }
+    return segments;
+}
+
+// Stop at every waypoint: a straight rest-to-rest move down each leg, with a turn in place
+// first wherever a leg sets off in a different direction from the last one
+std::vector<TrajectorySegment> planRestToRest(const std::vector<Pose>& waypoints, const std::vector<double>& maxVoltages,
+                                              DriveLimits limits, double track_width, double dt) {
+    std::vector<TrajectorySegment> segments;
+    auto add = [&](Pose start, Pose end, size_t leg) {
+        Pose rest = {0, 0, 0};
+        double tf = computeSegmentTime(start, end, maxVoltages[leg], limits, track_width);
+        int steps = std::max(1, int(std::ceil(tf / dt)));
+        tf = steps * dt;
+        segments.push_back({computeQuinticSegment(start, rest, rest, end, rest, rest, tf), tf, steps, leg});
+    };
+
+    double heading = 0;
+    for (size_t i = 0; i + 1 < waypoints.size(); ++i) {
+        const Pose& from = waypoints[i];
+        const Pose& to = waypoints[i + 1];
+        double direction = std::atan2(to.y - from.y, to.x - from.x);
+        if (i > 0) direction = heading + std::remainder(direction - heading, 2 * M_PI);
+        if (i > 0 && std::abs(direction - heading) > 1e-6) add({from.x, from.y, heading}, {from.x, from.y, direction}, i);
+        heading = direction;
+        add({from.x, from.y, heading}, {to.x, to.y, heading}, i);
+    }
+    return segments;
+}
+
+double totalTime(const std::vector<TrajectorySegment>& segments) {
+    double total = 0;
+    for (const TrajectorySegment& seg : segments) total += seg.tf;
+    return total;
+}
+
+// Plan a continuous path through the waypoints. Segments start with their rest-to-rest
+// durations and the whole spline is scaled so the tightest segment just meets its limits.
+// Joints couple neighbouring segments, so stretching the bottleneck tends to make it
+// overshoot; instead the segments with headroom are shortened towards the bottleneck's
+// load, keeping whichever timing gives the shortest total. The coupling also drags a low
+// voltage cap into the segments either side of it, so stopping at every waypoint can
+// still be faster; the rest-to-rest plan is kept as a candidate and the faster of the two
+// is returned. Durations are rounded up to whole control periods.
+std::vector<TrajectorySegment> planContinuousPath(const std::vector<Pose>& waypoints, const std::vector<double>& maxVoltages,
+                                                  DriveLimits limits, double track_width, double dt) {
+    // a waypoint on top of the last one makes a segment with nothing to time, and the solve singular
+    for (size_t i = 1; i < waypoints.size(); ++i) {
+        if (std::hypot(waypoints[i].x - waypoints[i - 1].x, waypoints[i].y - waypoints[i - 1].y) < 1e-6) {
+            std::cerr << "Waypoint " << i << " repeats the one before it\n";
+            return {};
+        }
+    }
+
+    const size_t count = waypoints.size() - 1;
+    std::vector<double> durations(count), loads(count);
+    for (size_t i = 0; i < count; ++i) {
+        durations[i] = computeSegmentTime(waypoints[i], waypoints[i + 1], maxVoltages[i], limits, track_width);
+    }
+    std::vector<TrajectorySegment> restToRest = planRestToRest(waypoints, maxVoltages, limits, track_width, dt);
+
+    std::vector<double> best = durations;
+    double bestScale = 0, bestTotal = INFINITY;
+    for (int iteration = 0; iteration < 10; ++iteration) {
+        std::vector<SegmentCoeffs> coeffs = solveContinuousSpline(waypoints, durations);
+        if (coeffs.empty()) break;
+
+        // Scaling every duration by s scales the solution in time, so the plan only needs the worst load
+        double scale = 0, total = 0;
+        for (size_t i = 0; i < count; ++i) {
+            loads[i] = segmentLoad(coeffs[i], durations[i], maxVoltages[i], limits, track_width);
+            scale = std::max(scale, loads[i]);
+            total += durations[i];
+        }
+        if (total * scale < bestTotal) {
+            best = durations;
+            bestScale = scale;
+            bestTotal = total * scale;
+        }
+        for (size_t i = 0; i < count; ++i) durations[i] *= std::sqrt(loads[i] / scale);
+    }
+    if (bestScale == 0) return restToRest;
+
+    for (double& duration : best) duration *= bestScale;
+    std::vector<TrajectorySegment> continuous = timedSegments(waypoints, best, dt);
+    return totalTime(continuous) < totalTime(restToRest) ? continuous : restToRest;
+}
+
+// Path speed |(vx, vy)| of a segment at time t
+double pathSpeed(const SegmentCoeffs& c, double t) {
+    double x, vx, ax, y, vy, ay;
+    evaluateQuintic(c.x, t, x, vx, ax);
+    evaluateQuintic(c.y, t, y, vy, ay);
+    return std::hypot(vx, vy);
+}
+
+// Distance travelled along a segment between t0 and t1, by 5-point Gauss-Legendre quadrature
+double segmentLength(const SegmentCoeffs& c, double t0, double t1) {
+    static const double nodes[5] = {-0.9061798459386640, -0.5384693101056831, 0, 0.5384693101056831, 0.9061798459386640};
+    static const double weights[5] = {0.2369268850561891, 0.4786286704993665, 0.5688888888888889, 0.4786286704993665, 0.2369268850561891};
+    double half = (t1 - t0) / 2, mid = (t0 + t1) / 2, length = 0;
+    for (int k = 0; k < 5; ++k) length += weights[k] * pathSpeed(c, mid + half * nodes[k]);
+    return length * half;
+}
+
+// Segment and time within it of a point on the path
+struct PathLocation {
+    size_t segment;
+    double t;
+};
+
+// Monotone table of distance travelled at evenly spaced times along every segment. A
+// distance is located by binary search for its interval and linear inverse interpolation
+// inside it, so lookups are O(log n) in the number of knots.
+struct ArcLengthTable {
+    std::vector<float> distance, t;
+    std::vector<uint16_t> segment;
+
+    double length() const { return distance.back(); }
+
+    PathLocation locate(double d) const {
+        size_t k = interval(d);
+        float span = distance[k] - distance[k - 1];
+        if (span <= 0) return {segment[k], t[k]};
+        double u = std::clamp((d - distance[k - 1]) / span, 0.0, 1.0);
+        return {segment[k], t[k - 1] + u * (t[k] - t[k - 1])};
+    }
+
+    // locate, then Newton steps on the exact length from the knot below. The linear guess is
+    // a few millimetres out between knots, which is most of a sample when spacing points.
+    PathLocation locateExact(const std::vector<TrajectorySegment>& segments, double d) const {
+        size_t k = interval(d);
+        PathLocation loc = locate(d);
+        if (distance[k] <= distance[k - 1]) return loc;
+        const SegmentCoeffs& c = segments[loc.segment].coeffs;
+        for (int i = 0; i < 2; ++i) {
+            double speed = pathSpeed(c, loc.t);
+            if (speed < 1e-9) break;
+            double error = distance[k - 1] + segmentLength(c, t[k - 1], loc.t) - d;
+            loc.t = std::clamp(loc.t - error / speed, double(t[k - 1]), double(t[k]));
+        }
+        return loc;
+    }
+
+private:
+    // Knot at the end of the interval holding distance d
+    size_t interval(double d) const {
+        size_t k = std::upper_bound(distance.begin(), distance.end(), float(d)) - distance.begin();
+        return std::clamp<size_t>(k, 1, distance.size() - 1);
+    }
+};
+
+// Build the arc length table with a fixed number of quadrature intervals per segment.
+// Each segment contributes its own start and end knots, so the two knots either side of
+// a joint share a distance and an interval never spans two segments.
+ArcLengthTable buildArcLengthTable(const std::vector<TrajectorySegment>& segments, int intervals = 16) {
+    ArcLengthTable table;
+    size_t knots = segments.size() * (intervals + 1);
+    table.distance.reserve(knots);
+    table.t.reserve(knots);
+    table.segment.reserve(knots);
+
+    double total = 0;
+    for (size_t i = 0; i < segments.size(); ++i) {
+        const TrajectorySegment& seg = segments[i];
+        for (int k = 0; k <= intervals; ++k) {
+            double t = seg.tf * k / intervals;
+            if (k > 0) total += segmentLength(seg.coeffs, seg.tf * (k - 1) / intervals, t);
+            table.distance.push_back(total);
+            table.t.push_back(t);
+            table.segment.push_back(i);
+        }
+    }
+    return table;
+}
+
+// Sample the path at evenly spaced distances instead of evenly spaced times
+void sampleByDistance(const std::vector<TrajectorySegment>& segments, const ArcLengthTable& table, double spacing, ProfileBuffer& out) {
+    const size_t points = size_t(table.length() / spacing) + 1;
+    out.resize(points);
+
+    for (size_t i = 0; i < points; ++i) {
+        PathLocation loc = table.locateExact(segments, spacing * i);
+        const SegmentCoeffs& c = segments[loc.segment].coeffs;
+        double x, vx, ax, y, vy, ay, theta, omega, alpha;
 
-        for (const auto& target : profile) {
-            WheelSpeeds speeds = ramseteControl(robotPose, target, 2.0, 0.7, track_width);
+        evaluateQuintic(c.x, loc.t, x, vx, ax);
+        evaluateQuintic(c.y, loc.t, y, vy, ay);
+        evaluateQuintic(c.theta, loc.t, theta, omega, alpha);
 
-            // Clamp voltages
-            double left_voltage = clampVoltage(speeds.left * 12, maxVoltage);
-            double right_voltage = clampVoltage(speeds.right * 12, maxVoltage);
+        out.x[i] = x;
+        out.y[i] = y;
+        out.theta[i] = theta;
+        out.vx[i] = vx;
+        out.vy[i] = vy;
+        out.omega[i] = omega;
+        out.ax[i] = ax;
+        out.ay[i] = ay;
+        out.alpha[i] = alpha;
+    }
+}
+
+#ifndef __arm__
+// Write the setpoints executePath would visit as a packed trajectory asset. Heading, turn
+// rate and angular acceleration are the path reference the robot can follow, not the
+// spline's theta channel.
+bool writeTrajectoryAsset(const char* path, const std::vector<TrajectorySegment>& segments, const std::vector<double>& maxVoltages, double dt) {
+    if (segments.empty()) return false;
+    uint32_t points = 1;
+    for (const TrajectorySegment& seg : segments) points += seg.steps;
+
+    std::vector<float> columns(size_t(points) * TRAJ_COLUMNS);
+    PathReference target = startReference(segments[0].coeffs, segments[0].tf);
+    uint32_t i = 0;
+    for (TrajectoryIterator it(segments); !it.done(); ++it, ++i) {
+        MotionProfile p = *it;
+        const TrajectorySegment& segment = segments[it.segmentIndex()];
+        if (i > 0) target = pathReference(p, target, segment.tf / segment.steps);
+        const double values[TRAJ_COLUMNS] = {p.x, p.y, target.pose.theta, p.vx, p.vy, target.omega, p.ax, p.ay, target.alpha,
+                                             maxVoltages[it.leg()]};
+        for (int c = 0; c < TRAJ_COLUMNS; ++c) columns[size_t(c) * points + i] = values[c];
+    }
+
+    TrajectoryAssetHeader header = {TRAJECTORY_MAGIC, TRAJECTORY_VERSION, TRAJ_COLUMNS, points, float(dt)};
+    std::ofstream out(path, std::ios::binary);
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char*>(columns.data()), columns.size() * sizeof(float));
+    return bool(out);
+}
+
+// Read a waypoint spec: one "x y theta voltage" line per waypoint, with theta in degrees
+// and voltage capping the segment that ends at that waypoint. '#' starts a comment.
+bool readWaypointSpec(const char* path, std::vector<Pose>& waypoints, std::vector<double>& maxVoltages) {
+    std::ifstream in(path);
+    if (!in) return false;
+
+    std::string line;
+    while (std::getline(in, line)) {
+        line = line.substr(0, line.find('#'));
+        std::istringstream fields(line);
+        double x, y, theta, voltage = 12.0;
+        if (!(fields >> x >> y >> theta)) continue;
+        fields >> voltage;
+
+        if (!waypoints.empty()) maxVoltages.push_back(voltage);
+        waypoints.push_back({x, y, theta * M_PI / 180});
+    }
+    return waypoints.size() >= 2;
+}
+
+// Plan a waypoint spec offline and write it out for the firmware to load with ASSET()
+int compileTrajectory(const char* specPath, const char* outPath, DriveLimits limits, double track_width, double dt) {
+    std::vector<Pose> waypoints;
+    std::vector<double> maxVoltages;
+    if (!readWaypointSpec(specPath, waypoints, maxVoltages)) {
+        std::cerr << "Could not read at least two waypoints from " << specPath << "\n";
+        return 1;
+    }
+
+    std::vector<TrajectorySegment> segments = planContinuousPath(waypoints, maxVoltages, limits, track_width, dt);
+    if (segments.empty() || !writeTrajectoryAsset(outPath, segments, maxVoltages, dt)) {
+        std::cerr << "Could not compile " << specPath << "\n";
+        return 1;
+    }
+
+    std::cout << "Compiled " << waypoints.size() << " waypoints to " << outPath << " (" << totalTime(segments) << "s)\n";
+    return 0;
+}
+
+// Time a callable over many iterations, returning mean nanoseconds per call
+template <typename F>
+double benchmarkNs(F&& fn, int iterations) {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) fn(i);
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(end - start).count() / iterations;
+}
+
+// Compare the per-axis QR solve against the batched closed-form solve
+void benchmarkQuinticSolvers() {
+    const int iterations = 200000;
+    Pose start = {0, 0, 0}, end = {2, 1, M_PI/4};
+    Pose v0 = {0.1, 0, 0}, vf = {0.3, 0.2, 0.1}, a0 = {0, 0.05, 0}, af = {0, 0, 0};
+    volatile double sink = 0;
+
+    double qrNs = benchmarkNs([&](int i) {
+        double tf = 1.0 + (i & 7) * 0.25;
+        QuinticCoeffs xC = computeQuinticSplineQR(start.x, v0.x, a0.x, end.x, vf.x, af.x, tf);
+        QuinticCoeffs yC = computeQuinticSplineQR(start.y, v0.y, a0.y, end.y, vf.y, af.y, tf);
+        QuinticCoeffs thetaC = computeQuinticSplineQR(start.theta, v0.theta, a0.theta, end.theta, vf.theta, af.theta, tf);
+        sink = sink + xC.a5 + yC.a5 + thetaC.a5;
+    }, iterations);
+
+    double closedNs = benchmarkNs([&](int i) {
+        double tf = 1.0 + (i & 7) * 0.25;
+        SegmentCoeffs c = computeQuinticSegment(start, v0, a0, end, vf, af, tf);
+        sink = sink + c.x.a5 + c.y.a5 + c.theta.a5;
+    }, iterations);
+
+    // Make sure both solvers agree before trusting the timings
+    double maxError = 0;
+    for (int i = 0; i < 8; ++i) {
+        double tf = 1.0 + i * 0.25;
+        QuinticCoeffs ref = computeQuinticSplineQR(start.y, v0.y, a0.y, end.y, vf.y, af.y, tf);
+        QuinticCoeffs fast = computeQuinticSegment(start, v0, a0, end, vf, af, tf).y;
+        double r[6] = {ref.a0, ref.a1, ref.a2, ref.a3, ref.a4, ref.a5};
+        double f[6] = {fast.a0, fast.a1, fast.a2, fast.a3, fast.a4, fast.a5};
+        for (int k = 0; k < 6; ++k) maxError = std::max(maxError, std::abs(r[k] - f[k]));
+    }
+
+    std::cout << "Quintic solve (3 axes): QR " << qrNs << " ns, closed-form " << closedNs
+              << " ns, speedup " << qrNs / closedNs << "x, max coeff error " << maxError << "\n";
+}
+
+// Compare the AoS power-expansion loop against the SoA Horner sampler
+void benchmarkProfileSampler() {
+    Pose rest = {0, 0, 0};
+    SegmentCoeffs c = computeQuinticSegment({0, 0, 0}, rest, rest, {2, 1, M_PI/4}, rest, rest, 5.0);
+    ProfileBuffer buffer;
+    volatile double sink = 0;
+
+    for (int steps : {100, 1000, 10000}) {
+        const int iterations = 2000000 / steps;
+
+        double loopNs = benchmarkNs([&](int) {
+            std::vector<MotionProfile> profile = generateMotionProfile(c.x, c.y, c.theta, 5.0, steps);
+            sink = sink + profile.back().x;
+        }, iterations);
+
+        double samplerNs = benchmarkNs([&](int) {
+            sampleMotionProfile(c, 5.0, steps, buffer);
+            sink = sink + buffer.x.back();
+        }, iterations);
+
+        std::vector<MotionProfile> reference = generateMotionProfile(c.x, c.y, c.theta, 5.0, steps);
+        double maxError = 0;
+        for (size_t i = 0; i < reference.size(); ++i) {
+            MotionProfile p = buffer[i];
+            maxError = std::max({maxError, std::abs(p.x - reference[i].x), std::abs(p.y - reference[i].y),
+                                 std::abs(p.theta - reference[i].theta), std::abs(p.vx - reference[i].vx)});
+        }
+
+        std::cout << "Profile sampling (" << steps << " steps): loop " << loopNs / 1000 << " us, sampler "
+                  << samplerNs / 1000 << " us, speedup " << loopNs / samplerNs << "x, max error " << maxError << "\n";
+    }
+}
+
+// Time the continuous spline solve as the number of waypoints grows
+void benchmarkContinuousSpline() {
+    volatile double sink = 0;
+
+    for (int count : {4, 16, 64, 256, 1024}) {
+        std::vector<Pose> waypoints;
+        std::vector<double> durations(count - 1, 1.0);
+        for (int i = 0; i < count; ++i) {
+            waypoints.push_back({double(i), std::sin(i * 0.7), std::cos(i * 0.3)});
+        }
+
+        const int iterations = std::max(10, 20000 / count);
+        double solveNs = benchmarkNs([&](int) {
+            std::vector<SegmentCoeffs> coeffs = solveContinuousSpline(waypoints, durations);
+            sink = sink + coeffs.back().x.a5;
+        }, iterations);
+
+        std::cout << "Continuous spline (" << count << " waypoints): " << solveNs / 1000 << " us\n";
+    }
+}
+
+// Compare the arc length table against brute-force dense resampling with a linear search
+void benchmarkArcLength() {
+    DriveLimits limits = {1.0, 2.0};
+    std::vector<Pose> waypoints;
+    for (int i = 0; i < 16; ++i) waypoints.push_back({double(i), std::sin(i * 0.7), std::cos(i * 0.3)});
+    std::vector<TrajectorySegment> segments =
+        planContinuousPath(waypoints, std::vector<double>(waypoints.size() - 1, 12.0), limits, 0.5, 0.01);
+
+    const int denseSteps = 1000;
+    std::vector<double> denseDistance;
+    std::vector<PathLocation> denseLocation;
+    auto buildDense = [&]() {
+        denseDistance.clear();
+        denseLocation.clear();
+        double total = 0, px = 0, py = 0;
+        for (size_t i = 0; i < segments.size(); ++i) {
+            for (int k = 0; k <= denseSteps; ++k) {
+                double t = segments[i].tf * k / denseSteps, x, vx, ax, y, vy, ay;
+                evaluateQuintic(segments[i].coeffs.x, t, x, vx, ax);
+                evaluateQuintic(segments[i].coeffs.y, t, y, vy, ay);
+                if (!denseDistance.empty()) total += std::hypot(x - px, y - py);
+                px = x;
+                py = y;
+                denseDistance.push_back(total);
+                denseLocation.push_back({i, t});
+            }
+        }
+    };
+    auto locateDense = [&](double d) {
+        size_t k = 0;
+        while (k + 1 < denseDistance.size() && denseDistance[k + 1] <= d) ++k;
+        return denseLocation[k];
+    };
+
+    volatile double sink = 0;
+    ArcLengthTable table;
+    double tableBuildNs = benchmarkNs([&](int) {
+        table = buildArcLengthTable(segments);
+        sink = sink + table.length();
+    }, 200);
+    double denseBuildNs = benchmarkNs([&](int) {
+        buildDense();
+        sink = sink + denseDistance.back();
+    }, 20);
+
+    const int queries = 1000;
+    double length = table.length();
+    double tableQueryNs = benchmarkNs([&](int i) {
+        sink = sink + table.locate(length * (i % queries) / queries).t;
+    }, 100000);
+    double denseQueryNs = benchmarkNs([&](int i) {
+        sink = sink + locateDense(length * (i % queries) / queries).t;
+    }, 10000);
+
+    // Position error between the two lookups
+    double maxError = 0;
+    for (int i = 0; i < queries; ++i) {
+        PathLocation a = table.locate(length * i / queries), b = locateDense(length * i / queries);
+        double ax, ay, bx, by, v, acc;
+        evaluateQuintic(segments[a.segment].coeffs.x, a.t, ax, v, acc);
+        evaluateQuintic(segments[a.segment].coeffs.y, a.t, ay, v, acc);
+        evaluateQuintic(segments[b.segment].coeffs.x, b.t, bx, v, acc);
+        evaluateQuintic(segments[b.segment].coeffs.y, b.t, by, v, acc);
+        maxError = std::max(maxError, std::hypot(ax - bx, ay - by));
+    }
+
+    // Points sampleByDistance places should sit one spacing apart along the path, so the
+    // chord between neighbours is within the curvature's sag of it
+    const double spacing = 0.02;
+    ProfileBuffer sampled;
+    double sampleNs = benchmarkNs([&](int) {
+        sampleByDistance(segments, table, spacing, sampled);
+        sink = sink + sampled.x.back();
+    }, 200);
+    double minGap = INFINITY, maxGap = 0;
+    for (size_t i = 1; i < sampled.size(); ++i) {
+        double gap = std::hypot(sampled.x[i] - sampled.x[i - 1], sampled.y[i] - sampled.y[i - 1]);
+        minGap = std::min(minGap, gap);
+        maxGap = std::max(maxGap, gap);
+    }
+
+    std::cout << "Arc length (" << segments.size() << " segments, " << table.distance.size() << " knots): build "
+              << tableBuildNs / 1000 << " us vs dense " << denseBuildNs / 1000 << " us, query " << tableQueryNs
+              << " ns vs dense " << denseQueryNs << " ns, max position error " << maxError << " m\n";
+    std::cout << "Distance sampling (" << sampled.size() << " points at " << spacing * 100 << " cm): " << sampleNs / 1000
+              << " us, spacing " << minGap * 100 << " to " << maxGap * 100 << " cm\n";
+    if (maxGap - minGap > spacing * 0.05) std::cout << "  spacing off by more than 5%\n";
+}
+
+// Read a path asset from disk the way the firmware sees it after linking
+std::vector<uint8_t> readAssetFile(const char* file) {
+    std::ifstream in(file, std::ios::binary);
+    return std::vector<uint8_t>((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+}
+
+CompiledPath loadPathFile(const char* file, float driveRpm) {
+    std::vector<uint8_t> bytes = readAssetFile(file);
+    asset data = {bytes.data(), bytes.size()};
+    return parsePath(data, driveRpm);
+}
+
+// Per-tick cost of the windowed closest-point and lookahead search against scanning the
+// whole path, as the path grows
+void benchmarkPathSearch() {
+    for (const char* file : {"static/example.txt", "static/a.txt"}) {
+        CompiledPath path = loadPathFile(file, 343);
+        if (path.size() > 0) std::cout << "Path " << file << ": " << path.size() << " points, " << path.length() << " in\n";
+    }
+
+    const float lookahead = 8, spacing = 0.5f, step = 0.6f;
+    for (int points : {100, 1000, 10000}) {
+        CompiledPath path;
+        for (int i = 0; i < points; ++i) path.push(i * spacing, 24 * std::sin(i * spacing / 30), 1);
+
+        // The robot walks the path a little off to one side
+        std::vector<float> rx, ry;
+        for (float d = 0; d < path.length() - lookahead; d += step) {
+            float px, py;
+            pathPoint(path, d / spacing, px, py);
+            rx.push_back(px);
+            ry.push_back(py + 1);
+        }
+
+        volatile float sink = 0;
+        size_t closest = 0;
+        float target = 0;
+        double windowedNs = benchmarkNs([&](int i) {
+            size_t k = i % rx.size();
+            if (k == 0) closest = 0, target = 0;
+            closest = closestPoint(path, rx[k], ry[k], closest, lookahead);
+            target = lookaheadIndex(path, rx[k], ry[k], lookahead, closest, target);
+            sink = sink + target;
+        }, 20000);
+        double fullNs = benchmarkNs([&](int i) {
+            size_t k = i % rx.size();
+            size_t c = closestPoint(path, rx[k], ry[k], 0, INFINITY);
+            float t = 0;
+            for (size_t j = 0; j + 1 < path.size(); ++j) {
+                float dx = path.x[j + 1] - path.x[j], dy = path.y[j + 1] - path.y[j];
+                float fx = path.x[j] - rx[k], fy = path.y[j] - ry[k];
+                float a = dx * dx + dy * dy, b = 2 * (fx * dx + fy * dy), cc = fx * fx + fy * fy - lookahead * lookahead;
+                float disc = b * b - 4 * a * cc;
+                if (disc < 0) continue;
+                float u = (-b + std::sqrt(disc)) / (2 * a);
+                if (u >= 0 && u <= 1 && j >= c) t = j + u;
+            }
+            sink = sink + t;
+        }, points >= 10000 ? 200 : 2000);
+
+        std::cout << "Path search (" << points << " points): windowed " << windowedNs << " ns/tick vs full scan "
+                  << fullNs << " ns/tick\n";
+    }
+}
+
+// Build static/a.txt from its Bezier controls against parsing the exported point list,
+// and check the curve passes through the exported points
+void benchmarkBezierPath() {
+    std::vector<uint8_t> bytes = readAssetFile("static/a.txt");
+    if (bytes.empty()) return;
+    asset data = {bytes.data(), bytes.size()};
+
+    volatile float sink = 0;
+    double pointsNs = benchmarkNs([&](int) { sink = sink + parsePath(data, 343).length(); }, 2000);
+    BezierPath bezier = parseBezierPath(data, 343);
+    double controlsNs = benchmarkNs([&](int) { sink = sink + parseBezierPath(data, 343).segments.size(); }, 2000);
+    CompiledPath sampled;
+    double sampleNs = benchmarkNs([&](int) {
+        sampled = sampleBezierPath(bezier, 0.25f);
+        sink = sink + sampled.length();
+    }, 2000);
+
+    // Distance from each exported point to the sampled curve
+    CompiledPath points = parsePath(data, 343);
+    float maxError = 0;
+    for (size_t i = 0; i < points.size(); ++i) {
+        float best = INFINITY;
+        for (size_t j = 0; j < sampled.size(); ++j)
+            best = std::min(best, std::hypot(points.x[i] - sampled.x[j], points.y[i] - sampled.y[j]));
+        maxError = std::max(maxError, best);
+    }
+    // Forward differencing drift at the segment end
+    float ex, ey;
+    bezier.segments.back().point(1, ex, ey);
+    float drift = std::hypot(sampled.x.back() - ex, sampled.y.back() - ey);
+
+    std::cout << "Bezier path (" << bezier.segments.size() << " segments): parse points " << pointsNs / 1000
+              << " us vs controls " << controlsNs / 1000 << " us + sample " << sampleNs / 1000 << " us for "
+              << sampled.size() << " points, max distance to exported points " << maxError << " in, end drift "
+              << drift << " in\n";
+}
+
+// Traverse time of the curvature and acceleration limited profile against running the whole
+// path at the one fixed speed that keeps its tightest corner under the lateral limit, with
+// the same acceleration limits at the ends
+void benchmarkVelocityProfile() {
+    const float trackWidth = 12; // inches
+    PathLimits limits = {60, 80, 60};
+
+    std::vector<uint8_t> bytes = readAssetFile("static/a.txt");
+    asset data = {bytes.data(), bytes.size()};
+    std::vector<std::pair<const char*, CompiledPath>> paths = {
+        {"example.txt", loadPathFile("static/example.txt", 343)},
+        {"a.txt controls", sampleBezierPath(parseBezierPath(data, 343), 0.5f)},
+    };
+    for (auto& [name, path] : paths) {
+        if (path.size() < 2) continue;
+        volatile float sink = 0;
+        float profileTime = 0;
+        double profileNs = benchmarkNs([&](int) {
+            profileTime = profileVelocity(path, limits, trackWidth);
+            sink = sink + profileTime;
+        }, 2000);
+
+        float fixedSpeed = limits.maxVelocity;
+        for (float k : path.curvature) {
+            k = std::fabs(k);
+            if (k > 0) fixedSpeed = std::min({fixedSpeed, std::sqrt(limits.maxLateralAcceleration / k),
+                                              limits.maxVelocity / (1 + k * trackWidth / 2)});
+        }
+        CompiledPath fixed = path;
+        std::fill(fixed.speed.begin(), fixed.speed.end(), 1.0f);
+        std::fill(fixed.curvature.begin(), fixed.curvature.end(), 0.0f);
+        float fixedTime = profileVelocity(fixed, {fixedSpeed, limits.maxAcceleration, limits.maxLateralAcceleration}, trackWidth);
+
+        std::cout << "Velocity profile " << name << " (" << path.length() << " in): fixed " << fixedSpeed << " in/s "
+                  << fixedTime << " s vs profiled " << profileTime << " s, built in " << profileNs / 1000 << " us\n";
+    }
+}
+
+// Turn in place on a simulated drivetrain with static friction and a first-order lag, either
+// with angularPID alone (LemLib's gains from drivetrain.cpp, error per 10ms tick) or following
+// the S-curve profile. Returns the time until the heading stays within 1 degree, or -1.
+// Error and output every tick go to `trace` when given.
+struct SettleTrace {
+    int timeout; // ms
+    bool turn;
+    std::vector<float> error, output; // One sample per 10ms tick
+};
+
+double simulateTurn(double angle, bool profiled, SettleTrace* trace = nullptr) {
+    const double maxOmega = 700, lag = 0.25, friction = 6, dt = 0.01; // deg/s at 127, s, power
+    MotionProfile1D profile(angle, 450, 1500, ProfileShape::S_CURVE);
+    double heading = 0, omega = 0, previousError = profiled ? 0 : angle, settledSince = -1;
+    for (int tick = 0; tick < 300; ++tick) {
+        double t = tick * dt;
+        double power;
+        if (profiled) {
+            float position, velocity, acceleration;
+            profile.sample(t, position, velocity, acceleration);
+            double error = position - heading;
+            double push = velocity > 0 ? 1 : std::fabs(error) > 0.5 ? std::copysign(1, error) : 0;
+            power = 0.18 * velocity + 0.045 * acceleration + friction * push + 6 * error + 0.4 * (error - previousError) / dt;
+            previousError = error;
+        } else {
+            double error = angle - heading;
+            power = 3 * error + 10 * (error - previousError);
+            previousError = error;
+        }
+        power = std::clamp(power, -127.0, 127.0);
+        if (trace != nullptr && tick * 10 < trace->timeout) {
+            trace->error.push_back(angle - heading);
+            trace->output.push_back(power);
+        }
+        double effective = std::fabs(power) > friction ? power - std::copysign(friction, power) : 0;
+        omega += (effective / 127 * maxOmega - omega) / lag * dt;
+        heading += omega * dt;
+
+        if (std::fabs(angle - heading) < 1) {
+            if (settledSince < 0) settledSince = t;
+        } else {
+            settledSince = -1;
+        }
+    }
+    return settledSince;
+}
+
+void benchmarkTurnProfile() {
+    for (double angle : {45.0, 90.0, 135.0, 180.0}) {
+        MotionProfile1D trapezoid(angle, 450, 1500), scurve(angle, 450, 1500, ProfileShape::S_CURVE);
+        auto settle = [](double t) { return t < 0 ? std::string("none in 3 s") : std::to_string(int(t * 1000)) + " ms"; };
+        std::cout << "Turn " << angle << " deg: profile " << trapezoid.duration() * 1000 << " ms trapezoid, "
+                  << scurve.duration() * 1000 << " ms s-curve; simulated settle " << settle(simulateTurn(angle, false))
+                  << " PID vs " << settle(simulateTurn(angle, true)) << " profiled\n";
+    }
+}
+
+// Differential drive for pose controllers: each side lags its command like simulateTurn's
+// drivetrain and loses `friction` power to static friction. Compass heading in radians.
+// Arrival is when the robot last came within 1.5 in of the target to stay, -1 if it is outside
+struct SimulatedChassis {
+    double targetX, targetY;
+    double x = 0, y = 0, heading = 0, left = 0, right = 0; // inches, in/s
+    double time = 0, arrival = -1;
+    double peakLateral = 0; // in/s^2, v * omega, what would make the wheels slip
+
+    void step(double leftPower, double rightPower, double dt) {
+        const double maxSpeed = 74, lag = 0.12, friction = 6, trackWidth = 12;
+        auto side = [&](double& v, double power) {
+            power = std::clamp(power, -127.0, 127.0);
+            double effective = std::fabs(power) > friction ? power - std::copysign(friction, power) : 0;
+            v += (effective / 127 * maxSpeed - v) / lag * dt;
+        };
+        side(left, leftPower);
+        side(right, rightPower);
+        double v = (left + right) / 2, omega = (left - right) / trackWidth;
+        x += v * std::sin(heading) * dt;
+        y += v * std::cos(heading) * dt;
+        heading += omega * dt;
+        peakLateral = std::max(peakLateral, std::fabs(v * omega));
+        time += dt;
+        if (std::hypot(targetX - x, targetY - y) >= 1.5) arrival = -1;
+        else if (arrival < 0) arrival = time;
+    }
+};
+
+// Compass heading error in degrees, positive when the target is clockwise
+double headingError(double target, double heading) {
+    return std::remainder(target - heading, 2 * M_PI) * 180 / M_PI;
+}
+
+// LemLib's moveToPose loop with the gains from drivetrain.cpp: lateral P to the carrot capped
+// by its horizontalDrift slip speed, angular PD toward the carrot, then the target heading
+// once within 7.5 in. The carrot recomputes sin and cos of the target heading every tick.
+void lemlibBoomerang(SimulatedChassis& robot, double tx, double ty, double theta, double lead, double dt) {
+    double maxSpeed = 127, previousAngular = 0;
+    bool close = false;
+    double lateralOut = 0;
+    for (int tick = 0; tick * dt < 3; ++tick) {
+        double distance = std::hypot(tx - robot.x, ty - robot.y);
+        if (distance < 7.5 && !close) {
+            close = true;
+            maxSpeed = std::max(std::fabs(lateralOut), 60.0);
+        }
+        double thetaRad = theta * M_PI / 180;
+        double cx = tx - std::sin(thetaRad) * lead * distance, cy = ty - std::cos(thetaRad) * lead * distance;
+        if (close) cx = tx, cy = ty;
+
+        double toCarrot = std::atan2(cx - robot.x, cy - robot.y);
+        double angular = close ? headingError(thetaRad, robot.heading) : headingError(toCarrot, robot.heading);
+        double lateral = std::hypot(cx - robot.x, cy - robot.y);
+        double carrotCos = std::cos(headingError(toCarrot, robot.heading) * M_PI / 180);
+        lateral *= close ? carrotCos : (carrotCos < 0 ? -1 : 1);
+
+        lateralOut = std::clamp(5 * lateral, -maxSpeed, maxSpeed);
+        double angularOut = std::clamp(3 * angular + 10 * (angular - previousAngular), -maxSpeed, maxSpeed);
+        previousAngular = angular;
+        double curvature = arcCurvature(robot.x, robot.y, std::sin(robot.heading), std::cos(robot.heading), cx, cy);
+        double slip = curvature == 0 ? INFINITY : std::sqrt(2 * 9.8 / std::fabs(curvature));
+        lateralOut = std::clamp(lateralOut, -slip, slip);
+        double overturn = std::fabs(angularOut) + std::fabs(lateralOut) - maxSpeed;
+        if (overturn > 0) lateralOut -= lateralOut > 0 ? overturn : -overturn;
+        robot.step(lateralOut + angularOut, lateralOut - angularOut, dt);
+    }
+}
+
+// boomerangToPose's loop with the constants from drivetrain.cpp, simulated: feedforward along
+// the carrot arc, then PD onto the target heading within 7.5 in. Stops the drive once
+// lateralSettle is satisfied
+void profiledBoomerang(SimulatedChassis& robot, double tx, double ty, double theta, double lead, double dt) {
+    const float maxVelocity = 60, maxAcceleration = 80, maxLateral = 60 * 0.9;
+    const float kV = 1.7, kS = 6, kP = 1.0, turnKV = 0.18, turnKP = 6, turnKD = 0.4;
+    float previousError = 0;
+    BoomerangTarget target(tx, ty, theta, lead);
+    SettleDetector settle({1, 2, 20, 60, 4, 150}), arrive({1, 2, 20, 60, 4, 150});
+    for (int tick = 0; tick * dt < 3; ++tick) {
+        float sinHeading = std::sin(robot.heading), cosHeading = std::cos(robot.heading);
+        float distance = target.distance(robot.x, robot.y);
+        float along = (target.x - robot.x) * sinHeading + (target.y - robot.y) * cosHeading;
+        bool close = distance < 7.5f;
+        float cx = target.x, cy = target.y;
+        if (!close) target.carrot(robot.x, robot.y, cx, cy);
+        float curvature = close ? 0 : arcCurvature(robot.x, robot.y, sinHeading, cosHeading, cx, cy);
+        float remaining = close ? std::fabs(along) : std::hypot(cx - robot.x, cy - robot.y) + std::hypot(target.x - cx, target.y - cy);
+        float velocity = boomerangSpeed(curvature, remaining, maxVelocity, maxAcceleration, maxLateral);
+        if (close && along < 0) velocity = -velocity;
+        float measured = (robot.left + robot.right) / 2;
+        float forward = kV * velocity + (velocity == 0 ? 0 : std::copysign(kS, velocity)) + kP * (velocity - measured);
+        float error = close ? headingError(theta * M_PI / 180, robot.heading) : 0;
+        float turn = turnKV * velocity * curvature * float(180 / M_PI) + turnKP * error + turnKD * (error - previousError) / dt;
+        previousError = error;
+        turn = std::clamp(turn, -127.0f, 127.0f);
+        forward = std::clamp(forward, -(127 - std::fabs(turn)), 127 - std::fabs(turn));
+        if (settle.update(along, forward, 10) & arrive.update(distance, forward, 10)) forward = turn = 0;
+        robot.step(forward + turn, forward - turn, dt);
+    }
+}
+
+// Where a controller leaves the simulated robot after 3 s, and when it got within 1.5 in to stay
+struct BoomerangResult {
+    double arrival, distance, headingError, peakLateral;
+};
+
+template <typename Controller>
+BoomerangResult runBoomerang(Controller controller, double tx, double ty, double theta) {
+    SimulatedChassis robot = {tx, ty};
+    controller(robot, tx, ty, theta, 0.6, 0.01);
+    return {robot.arrival, std::hypot(tx - robot.x, ty - robot.y), std::fabs(headingError(theta * M_PI / 180, robot.heading)), robot.peakLateral};
+}
 
-            setMotorVoltage(left_voltage, right_voltage);
+// Carrot cost per tick with the target heading's sin and cos cached against recomputed, and
+// both controllers driving the same simulated robot onto a few poses from (0, 0) facing 0
+void benchmarkBoomerang() {
+    volatile float sink = 0;
+    BoomerangTarget target(24, 36, 90, 0.6);
+    double cachedNs = benchmarkNs([&](int i) {
+        float cx, cy;
+        target.carrot(i * 1e-3f, 0, cx, cy);
+        sink = sink + cx + cy;
+    }, 1000000);
+    double recomputedNs = benchmarkNs([&](int i) {
+        float px = i * 1e-3f, theta = 90 + sink * 1e-30f;
+        float back = 0.6f * std::hypot(24 - px, 36.0f);
+        float cx = 24 - back * std::sin(theta * float(M_PI) / 180), cy = 36 - back * std::cos(theta * float(M_PI) / 180);
+        sink = sink + cx + cy;
+    }, 1000000);
+    std::cout << "Boomerang carrot: " << cachedNs << " ns cached vs " << recomputedNs << " ns recomputing sin/cos\n";
 
-            robotPose = updateOdometry(speeds.left, speeds.right, track_width, dt);
+    auto time = [](double t) { return t < 0 ? std::string("never") : std::to_string(int(t * 1000)) + " ms"; };
+    for (auto [x, y, theta] : {std::tuple{0.0, 48.0, 0.0}, {24.0, 24.0, 90.0}, {-24.0, 36.0, -45.0}, {36.0, 12.0, 180.0}}) {
+        BoomerangResult lemlib = runBoomerang(lemlibBoomerang, x, y, theta);
+        BoomerangResult profiled = runBoomerang(profiledBoomerang, x, y, theta);
+        for (auto [name, result] : {std::pair{"LemLib", lemlib}, {"profiled", profiled}}) {
+            std::cout << "Boomerang to (" << x << ", " << y << ", " << theta << ") " << name << ": within 1.5 in at "
+                      << time(result.arrival) << ", ends " << result.distance << " in and " << result.headingError
+                      << " deg off, peak lateral " << result.peakLateral << " in/s^2\n";
         }
     }
 }
 
+// Sensors that sample on their own clocks, read by a 5ms odometry loop that wakes up late
+// by up to a millisecond. The robot drives a 3 s S-curve and stops; each reading is the
+// ideal tracking wheel or IMU value at that sensor's last sample. Compares integrating the
+// latest readings as they are against stamping them when they change and interpolating to a
+// common instant like TimedOdometry, by the pose each ends with.
+struct SampledSensor {
+    double period, phase; // s
+    float reading = 0;
+    double last = -1;
+
+    // Latest sample at time t of a signal given by `value`
+    template <typename F>
+    bool read(double t, F value) {
+        double sampled = std::floor((t - phase) / period) * period + phase;
+        if (sampled <= last) return false;
+        last = sampled;
+        reading = value(sampled);
+        return true;
+    }
+};
+
+void benchmarkTimeAlignment() {
+    const float verticalOffset = -3.35f, horizontalOffset = -7.5f;
+    const double duration = 3, fine = 1e-5;
+    auto speed = [&](double t) { return t < duration ? 50 * std::sin(M_PI * t / duration) : 0.0; };
+    auto omega = [&](double t) { return t < duration ? 2.5 * std::sin(2 * M_PI * t / duration) : 0.0; };
+
+    // Ground truth and the ideal sensor values along it, tabulated finely
+    size_t steps = size_t((duration + 0.2) / fine);
+    std::vector<float> vertical(steps + 1), horizontal(steps + 1), heading(steps + 1);
+    PlanarPose truth;
+    double verticalTravel = 0, horizontalTravel = 0;
+    for (size_t i = 0; i < steps; ++i) {
+        double t = i * fine;
+        vertical[i] = verticalTravel;
+        horizontal[i] = horizontalTravel;
+        heading[i] = truth.theta;
+        double v = speed(t), w = omega(t);
+        truth.x += v * std::sin(truth.theta) * fine;
+        truth.y += v * std::cos(truth.theta) * fine;
+        truth.theta += w * fine;
+        verticalTravel += (v - verticalOffset * w) * fine;
+        horizontalTravel += -horizontalOffset * w * fine;
+    }
+    vertical[steps] = verticalTravel;
+    horizontal[steps] = horizontalTravel;
+    heading[steps] = truth.theta;
+    auto lookup = [&](const std::vector<float>& table) {
+        return [&table, fine](double t) { return table[std::min(table.size() - 1, size_t(std::max(0.0, t) / fine))]; };
+    };
+
+    SampledSensor verticalSensor{0.005, 0.001}, horizontalSensor{0.005, 0.003}, imuSensor{0.010, 0.007};
+    TimedSignal<> verticalSignal, horizontalSignal, headingSignal;
+    PlanarPose naive, aligned;
+    float naiveLast[3] = {0, 0, 0}, alignedLast[3] = {0, 0, 0};
+    uint64_t alignedAt = 0;
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<double> late(0, 0.001);
+    for (int tick = 1; tick * 0.005 < duration + 0.2; ++tick) {
+        double t = tick * 0.005 + late(rng);
+        uint64_t now = uint64_t(t * 1e6);
+        if (verticalSensor.read(t, lookup(vertical))) verticalSignal.push(now, verticalSensor.reading);
+        if (horizontalSensor.read(t, lookup(horizontal))) horizontalSignal.push(now, horizontalSensor.reading);
+        if (imuSensor.read(t, lookup(heading))) headingSignal.push(now, imuSensor.reading);
+
+        float readings[3] = {verticalSensor.reading, horizontalSensor.reading, imuSensor.reading};
+        integrateArc(naive, readings[0] - naiveLast[0], readings[1] - naiveLast[1], readings[2] - naiveLast[2],
+                     verticalOffset, horizontalOffset);
+        std::copy(readings, readings + 3, naiveLast);
+
+        if (headingSignal.size() == 0) continue;
+        uint64_t common = std::min({verticalSignal.latestTime(), horizontalSignal.latestTime(), headingSignal.latestTime()});
+        if (common <= alignedAt) continue;
+        float values[3] = {verticalSignal.at(common), horizontalSignal.at(common), headingSignal.at(common)};
+        if (alignedAt != 0) {
+            integrateArc(aligned, values[0] - alignedLast[0], values[1] - alignedLast[1], values[2] - alignedLast[2],
+                         verticalOffset, horizontalOffset);
+        }
+        std::copy(values, values + 3, alignedLast);
+        alignedAt = common;
+    }
+    auto error = [&](const PlanarPose& pose) { return std::hypot(pose.x - truth.x, pose.y - truth.y); };
+    std::cout << "Odometry over a " << duration << " s S-curve: latest readings end " << error(naive)
+              << " in off, time-aligned " << error(aligned) << " in off (true pose " << truth.x << ", " << truth.y << ")\n";
+}
+
+// Dead reckoning with real sideways travel: 2 s of driving forward through a turn while
+// being shoved left at up to 20 in/s, exact wheel readings every 5 ms. The other replays only
+// see the horizontal wheel turn with the robot, so a sign slip in the slide shows up only here
+void benchmarkSidewaysOdometry() {
+    const float verticalOffset = -3.35f, horizontalOffset = -7.5f;
+    const double duration = 2, fine = 1e-5;
+    const int perTick = 500;
+    PlanarPose truth, dead;
+    double verticalTravel = 0, horizontalTravel = 0, lastVertical = 0, lastHorizontal = 0, lastHeading = 0;
+    int steps = int(duration / fine);
+    for (int i = 1; i <= steps; ++i) {
+        double t = i * fine;
+        double v = 30 * std::sin(M_PI * t / duration), slide = 20 * std::sin(M_PI * t / duration);
+        double w = 1.5 * std::sin(2 * M_PI * t / duration);
+        double s = std::sin(truth.theta), c = std::cos(truth.theta);
+        truth.x += (v * s - slide * c) * fine;
+        truth.y += (v * c + slide * s) * fine;
+        truth.theta += w * fine;
+        verticalTravel += (v - verticalOffset * w) * fine;
+        horizontalTravel += (slide - horizontalOffset * w) * fine;
+        if (i % perTick != 0 && i != steps) continue;
+        integrateArc(dead, verticalTravel - lastVertical, horizontalTravel - lastHorizontal, truth.theta - lastHeading,
+                     verticalOffset, horizontalOffset);
+        lastVertical = verticalTravel;
+        lastHorizontal = horizontalTravel;
+        lastHeading = truth.theta;
+    }
+    std::cout << "Odometry shoved sideways through a turn: " << std::hypot(dead.x - truth.x, dead.y - truth.y)
+              << " in off (true pose " << truth.x << ", " << truth.y << ")\n";
+}
+
+// Pose filter replay: 10 s round a 40 in circle with a vertical wheel reading 2% long, a
+// gyro with a 0.01 rad/s bias, a left-facing distance sensor at 20 Hz that catches something
+// other than the wall one time in twenty, and a 20 Hz GPS good to an inch. Reports where dead
+// reckoning and the filter with each extra sensor end up, and what an update costs.
+void benchmarkPoseFilter() {
+    const float verticalOffset = -3.35f, horizontalOffset = -7.5f, dt = 0.005f;
+    const float speed = 40, radius = 40;
+    const SensorMount left = {-6, 0, -float(M_PI) / 2};
+    std::mt19937 rng(11);
+    std::normal_distribution<float> gaussian(0, 1);
+    std::uniform_real_distribution<float> uniform(0, 1);
+
+    struct Run {
+        const char* name;
+        bool ranges, gps;
+        PoseFilter filter;
+        float error = 0;
+    };
+    std::vector<Run> runs = {{"wheels and gyro", false, false, PoseFilter()}, {"+ distance", true, false, PoseFilter()},
+                             {"+ GPS", false, true, PoseFilter()}};
+    PlanarPose truth = {-radius, 0, 0}, dead = truth;
+    for (Run& run : runs) run.filter.reset(truth.x, truth.y, truth.theta);
+
+    double predictNs = 0, rangeNs = 0, gpsNs = 0;
+    int ticks = 0, rangeUpdates = 0, gpsUpdates = 0;
+    for (; ticks * dt < 10; ++ticks) {
+        float omega = speed / radius;
+        for (int k = 0; k < 10; ++k) {
+            truth.x += speed * std::sin(truth.theta) * dt / 10;
+            truth.y += speed * std::cos(truth.theta) * dt / 10;
+            truth.theta += omega * dt / 10;
+        }
+        float verticalRate = 1.02f * (speed - verticalOffset * omega) + 0.5f * gaussian(rng);
+        float horizontalRate = -horizontalOffset * omega + 0.5f * gaussian(rng);
+        float gyroRate = omega + 0.01f + 0.01f * gaussian(rng);
+        integrateArc(dead, verticalRate * dt, horizontalRate * dt, gyroRate * dt, verticalOffset, horizontalOffset);
+
+        bool rangeTick = ticks % 10 == 0, gpsTick = ticks % 10 == 5;
+        float px, py, heading;
+        sensorRay(truth.x, truth.y, truth.theta, left, px, py, heading);
+        float range = wallRange(px, py, heading) + 0.3f * gaussian(rng);
+        if (uniform(rng) < 0.05f) range *= 0.4f;
+        for (Run& run : runs) {
+            auto begin = std::chrono::steady_clock::now();
+            run.filter.predict(dt);
+            run.filter.updateWheels(verticalRate, horizontalRate, verticalOffset, horizontalOffset);
+            run.filter.updateGyro(gyroRate);
+            auto middle = std::chrono::steady_clock::now();
+            predictNs += std::chrono::duration<double, std::nano>(middle - begin).count();
+            if (run.ranges && rangeTick) {
+                run.filter.updateRange(range, left);
+                rangeNs += std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - middle).count();
+                rangeUpdates++;
+            }
+            if (run.gps && gpsTick) {
+                run.filter.updateGps(truth.x + gaussian(rng), truth.y + gaussian(rng), truth.theta + 0.02f * gaussian(rng), 1, 0.03f);
+                gpsNs += std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - middle).count();
+                gpsUpdates++;
+            }
+            run.error = std::max(run.error, float(std::hypot(run.filter.x() - truth.x, run.filter.y() - truth.y)));
+        }
+    }
+    std::cout << "Pose filter over 10 s: dead reckoning ends " << std::hypot(dead.x - truth.x, dead.y - truth.y) << " in off";
+    for (const Run& run : runs) std::cout << ", " << run.name << " worst " << run.error << " in";
+    std::cout << "\nPose filter cost: predict + wheels + gyro " << predictNs / (ticks * runs.size()) << " ns, range "
+              << rangeNs / rangeUpdates << " ns, GPS " << gpsNs / gpsUpdates << " ns\n";
+}
+
+// Relocalization from a rear and a left distance sensor at random poses with up to 3 in of
+// odometry drift, readings off by 0.3 in and one in ten caught by something short of the wall
+void benchmarkRelocalize() {
+    const SensorMount mounts[2] = {{0, -6, float(M_PI)}, {-6, 0, -float(M_PI) / 2}};
+    std::mt19937 rng(5);
+    std::uniform_real_distribution<float> position(-60, 60), drift(-3, 3), uniform(0, 1);
+    std::normal_distribution<float> gaussian(0, 1);
+    const int trials = 10000;
+    double before = 0, after = 0, ns = 0;
+    int fixed[2] = {0, 0};
+    for (int i = 0; i < trials; ++i) {
+        // square to the field like after a turnToHeading, give or take a degree
+        PlanarPose truth = {position(rng), position(rng), float(M_PI) / 2 * int(uniform(rng) * 4) + 0.017f * gaussian(rng)};
+        float ranges[2];
+        for (int k = 0; k < 2; ++k) {
+            float px, py, heading;
+            sensorRay(truth.x, truth.y, truth.theta, mounts[k], px, py, heading);
+            ranges[k] = wallRange(px, py, heading) + 0.3f * gaussian(rng);
+            if (uniform(rng) < 0.1f) ranges[k] *= 0.5f;
+        }
+        PlanarPose pose = {truth.x + drift(rng), truth.y + drift(rng), truth.theta};
+        before += std::hypot(pose.x - truth.x, pose.y - truth.y);
+        auto start = std::chrono::steady_clock::now();
+        int axes = relocalize(pose, mounts, ranges, 2);
+        ns += std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+        fixed[0] += axes & 1;
+        fixed[1] += axes >> 1;
+        after += std::hypot(pose.x - truth.x, pose.y - truth.y);
+    }
+    std::cout << "Relocalize: mean error " << before / trials << " in before, " << after / trials << " in after; x pinned "
+              << 100.0 * fixed[0] / trials << "%, y " << 100.0 * fixed[1] / trials << "%, " << ns / trials << " ns each\n";
+}
+
+// Particle filter at 500, 1000 and 2000 particles: the ray cast one particle at a time
+// against the packet-wide castRays, then a 10 s lap round the ladder at 40 in/s stepped at
+// 20 Hz, odometry reading 2% long with a 0.01 rad/s heading drift, and a left, right and
+// rear distance sensor off the full field map with one reading in ten caught short.
+// Reports the worst step against the 10 ms budget and where the estimate ends up.
+void benchmarkParticleFilter() {
+    const FieldMap map = FieldMap::highStakes();
+    const SensorMount mounts[3] = {{-6, 0, -float(M_PI) / 2}, {6, 0, float(M_PI) / 2}, {0, -6, float(M_PI)}};
+    const float speed = 40, radius = 40, dt = 0.05f;
+    for (int particles : {500, 1000, 2000}) {
+        std::mt19937 rng(13);
+        std::normal_distribution<float> gaussian(0, 1);
+        std::uniform_real_distribution<float> uniform(0, 1), position(-60, 60), angle(-M_PI, M_PI);
+
+        Eigen::ArrayXf ox(particles), oy(particles), dx(particles), dy(particles), range(particles);
+        for (int i = 0; i < particles; ++i) {
+            float heading = angle(rng);
+            ox[i] = position(rng);
+            oy[i] = position(rng);
+            dx[i] = std::sin(heading);
+            dy[i] = std::cos(heading);
+        }
+        volatile float sink = 0;
+        double scalarNs = benchmarkNs([&](int) {
+            for (int i = 0; i < particles; ++i) range[i] = map.castRay(ox[i], oy[i], dx[i], dy[i]);
+            sink = range[0];
+        }, 200);
+        double packetNs = benchmarkNs([&](int) {
+            map.castRays(ox, oy, dx, dy, range);
+            sink = range[0];
+        }, 200);
+
+        ParticleFilter filter(map, particles);
+        PlanarPose truth = {-radius, 0, 0}, dead = truth;
+        filter.reset(truth, 2, 0.05f);
+        double worstUs = 0, totalUs = 0, deadError = 0, filterError = 0;
+        int steps = 0;
+        for (; steps * dt < 10; ++steps) {
+            float omega = speed / radius;
+            float heading = truth.theta + omega * dt / 2;
+            truth.x += speed * dt * std::sin(heading);
+            truth.y += speed * dt * std::cos(heading);
+            truth.theta += omega * dt;
+            // odometry's view of the same step, in the robot's frame
+            float forward = 1.02f * speed * dt, dTheta = (omega + 0.01f) * dt;
+            float deadHeading = dead.theta + dTheta / 2;
+            dead.x += forward * std::sin(deadHeading);
+            dead.y += forward * std::cos(deadHeading);
+            dead.theta += dTheta;
+
+            float ranges[3];
+            for (int k = 0; k < 3; ++k) {
+                float px, py, beam;
+                sensorRay(truth.x, truth.y, truth.theta, mounts[k], px, py, beam);
+                ranges[k] = map.castRay(px, py, std::sin(beam), std::cos(beam)) + 0.3f * gaussian(rng);
+                if (uniform(rng) < 0.1f) ranges[k] *= 0.5f;
+            }
+            auto begin = std::chrono::steady_clock::now();
+            filter.predict(forward, 0, dTheta);
+            for (int k = 0; k < 3; ++k) filter.update(mounts[k], ranges[k]);
+            PlanarPose estimate = filter.estimate();
+            double us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - begin).count();
+            worstUs = std::max(worstUs, us);
+            totalUs += us;
+            sink = estimate.x;
+            deadError += std::hypot(dead.x - truth.x, dead.y - truth.y);
+            filterError += std::hypot(estimate.x - truth.x, estimate.y - truth.y);
+        }
+        std::cout << "Particle filter, " << particles << " particles: ray cast " << scalarNs / 1000 << " us scalar, "
+                  << packetNs / 1000 << " us packets; step mean " << totalUs / steps << " us, worst " << worstUs
+                  << " us of 10000; mean error dead reckoning " << deadError / steps << " in, filter "
+                  << filterError / steps << " in\n";
+    }
+}
+
+// Pose history: what a push and an interpolated lookup cost, a writer thread pushing at
+// full speed while two readers look up past instants and check what they get back, and the
+// pose filter lap with its left distance sensor 60 ms late, fused against the current
+// estimate and against the history's estimate from when the reading was taken.
+void benchmarkPoseHistory() {
+    PoseHistory<> history;
+    std::mt19937 rng(17);
+    uint64_t time = 0;
+    double pushNs = benchmarkNs([&](int i) {
+        time += 5000;
+        history.push({time, {i * 0.2f, i * -0.1f, i * 0.001f}, 40, -20, 0.2f});
+    }, 100000);
+    std::uniform_int_distribution<uint64_t> past(time - 600000, time);
+    std::vector<uint64_t> queries(4096);
+    for (uint64_t& query : queries) query = past(rng);
+    volatile float sink = 0;
+    double atNs = benchmarkNs([&](int i) {
+        PoseSample sample;
+        history.at(queries[i % queries.size()], sample);
+        sink = sample.pose.x;
+    }, 100000);
+
+    // the writer's samples lie on a line in time, so any torn or mismatched read shows up
+    PoseHistory<> shared;
+    std::atomic<bool> running {true};
+    std::atomic<uint64_t> newest {0};
+    std::thread writer([&] {
+        for (uint64_t t = 1; running; ++t) {
+            shared.push({t * 1000, {t * 0.5f, t * -0.25f, 0}, 500, -250, 0});
+            newest.store(t * 1000, std::memory_order_release);
+        }
+    });
+    std::atomic<long> reads {0}, wrong {0}, missed {0};
+    auto reader = [&](unsigned seed) {
+        std::mt19937 local(seed);
+        while (running) {
+            uint64_t latest = newest.load(std::memory_order_acquire);
+            if (latest < 64000) continue;
+            uint64_t query = latest - std::uniform_int_distribution<uint64_t>(0, 60000)(local);
+            PoseSample sample;
+            if (!shared.at(query, sample)) {
+                missed++;
+                continue;
+            }
+            reads++;
+            float expected = query / 1000.0f * 0.5f;
+            if (std::fabs(sample.pose.x - expected) > 1e-3f * expected || std::fabs(sample.pose.y + expected / 2) > 1e-3f * expected)
+                wrong++;
+        }
+    };
+    std::thread first(reader, 1), second(reader, 2);
+    std::this_thread::sleep_for(std::chrono::milliseconds(300));
+    running = false;
+    writer.join();
+    first.join();
+    second.join();
+    std::cout << "Pose history: push " << pushNs << " ns, lookup " << atNs << " ns; under a writer " << reads.load()
+              << " lookups, " << wrong.load() << " wrong, " << missed.load() << " gave up\n";
+
+    // the lap from benchmarkPoseFilter, with the range reading describing the pose 60 ms ago
+    const float verticalOffset = -3.35f, horizontalOffset = -7.5f, dt = 0.005f, speed = 40, radius = 40;
+    const SensorMount left = {-6, 0, -float(M_PI) / 2};
+    const int lag = 12; // ticks
+    std::normal_distribution<float> gaussian(0, 1);
+    PoseFilter naive, aligned;
+    PoseHistory<> estimates;
+    std::vector<PlanarPose> truths;
+    PlanarPose truth = {-radius, 0, 0};
+    naive.reset(truth.x, truth.y, truth.theta);
+    aligned.reset(truth.x, truth.y, truth.theta);
+    float naiveError = 0, alignedError = 0;
+    for (int tick = 0; tick * dt < 10; ++tick) {
+        float omega = speed / radius;
+        for (int k = 0; k < 10; ++k) {
+            truth.x += speed * std::sin(truth.theta) * dt / 10;
+            truth.y += speed * std::cos(truth.theta) * dt / 10;
+            truth.theta += omega * dt / 10;
+        }
+        truths.push_back(truth);
+        float verticalRate = 1.02f * (speed - verticalOffset * omega) + 0.5f * gaussian(rng);
+        float horizontalRate = -horizontalOffset * omega + 0.5f * gaussian(rng);
+        float gyroRate = omega + 0.01f + 0.01f * gaussian(rng);
+        uint64_t now = uint64_t(tick) * 5000;
+        for (PoseFilter* filter : {&naive, &aligned}) {
+            filter->predict(dt);
+            filter->updateWheels(verticalRate, horizontalRate, verticalOffset, horizontalOffset);
+            filter->updateGyro(gyroRate);
+        }
+        if (tick % 10 == 0 && tick >= lag) {
+            const PlanarPose& then = truths[tick - lag];
+            float px, py, heading;
+            sensorRay(then.x, then.y, then.theta, left, px, py, heading);
+            float range = wallRange(px, py, heading) + 0.3f * gaussian(rng);
+            naive.updateRange(range, left);
+            PoseSample sample;
+            if (estimates.at(now - lag * 5000, sample)) aligned.updateRange(range, left, sample.pose);
+        }
+        estimates.push({now, {aligned.x(), aligned.y(), aligned.theta()}, aligned.vx(), aligned.vy(), aligned.omega()});
+        naiveError = std::max(naiveError, float(std::hypot(naive.x() - truth.x, naive.y() - truth.y)));
+        alignedError = std::max(alignedError, float(std::hypot(aligned.x() - truth.x, aligned.y() - truth.y)));
+    }
+    std::cout << "Range 60 ms late over the 10 s lap: fused as current worst " << naiveError << " in, fused at its time worst "
+              << alignedError << " in\n";
+}
+
+// Drive straight with LemLib's lateral P controller on the same kind of simulated drivetrain
+void simulateDrive(double distance, SettleTrace& trace) {
+    const double maxSpeed = 74, lag = 0.12, friction = 6, dt = 0.01; // in/s at 127, s, power
+    double x = 0, v = 0;
+    for (int tick = 0; tick * 10 < trace.timeout; ++tick) {
+        double error = distance - x;
+        double power = std::clamp(5 * error, -127.0, 127.0);
+        trace.error.push_back(error);
+        trace.output.push_back(power);
+        double effective = std::fabs(power) > friction ? power - std::copysign(friction, power) : 0;
+        v += (effective / 127 * maxSpeed - v) / lag * dt;
+        x += v * dt;
+    }
+}
+
+// Traces in the format MotionQueue::logSettle prints: "motion <index> <timeout> <turn|move>"
+// followed by "<ms> <error> <output>" lines
+std::vector<SettleTrace> readSettleTraces(const char* path) {
+    std::vector<SettleTrace> traces;
+    std::ifstream in(path);
+    std::string line;
+    while (std::getline(in, line)) {
+        std::istringstream fields(line);
+        std::string first;
+        if (!(fields >> first)) continue;
+        if (first == "motion") {
+            int index, timeout;
+            std::string kind;
+            if (fields >> index >> timeout >> kind) traces.push_back({timeout, kind == "turn", {}, {}});
+        } else if (!traces.empty()) {
+            float error, output;
+            if (fields >> error >> output) {
+                traces.back().error.push_back(error);
+                traces.back().output.push_back(output);
+            }
+        }
+    }
+    return traces;
+}
+
+// Replay each trace through the settle detector and report when it would have ended the
+// motion against running to the timeout, which is what the zero exit ranges do today
+int replaySettle(const std::vector<SettleTrace>& traces) {
+    // Same as lateralSettle and angularSettle in src/headers/drivetrain.cpp
+    SettleParams lateral = {1, 2, 20, 60, 4, 150}, angular = {1, 10, 20, 60, 5, 150};
+
+    int totalTimeout = 0, totalExit = 0;
+    for (size_t i = 0; i < traces.size(); ++i) {
+        const SettleTrace& trace = traces[i];
+        SettleDetector detector(trace.turn ? angular : lateral);
+        int exit = trace.timeout;
+        for (size_t k = 0; k < trace.error.size(); ++k) {
+            if (detector.update(trace.error[k], trace.output[k], 10)) {
+                exit = int(k + 1) * 10;
+                break;
+            }
+        }
+        float finalError = trace.error.empty() ? 0 : trace.error[std::min(trace.error.size(), size_t(exit / 10)) - 1];
+        std::cout << "Motion " << i << " (" << (trace.turn ? "turn" : "move") << "): timeout " << trace.timeout
+                  << " ms, settled at " << exit << " ms with error " << finalError << "\n";
+        totalTimeout += trace.timeout;
+        totalExit += exit;
+    }
+    std::cout << "Settle detection: " << totalExit << " ms vs " << totalTimeout << " ms of timeouts, saves "
+              << totalTimeout - totalExit << " ms over " << traces.size() << " motions\n";
+    return 0;
+}
+
+// Built-in traces when no log is given: the skills routine's kind of turns (angularPID, then
+// profiled) and drives, simulated, with the timeouts autons.cpp gives them
+std::vector<SettleTrace> simulatedSettleTraces() {
+    std::vector<SettleTrace> traces;
+    for (bool profiled : {false, true}) {
+        for (auto [angle, timeout] : {std::pair{45.0, 600}, {90.0, 800}, {135.0, 900}, {180.0, 1000}}) {
+            traces.push_back({timeout, true, {}, {}});
+            simulateTurn(angle, profiled, &traces.back());
+        }
+    }
+    for (auto [distance, timeout] : {std::pair{12.0, 800}, {24.0, 1000}, {48.0, 2000}}) {
+        traces.push_back({timeout, false, {}, {}});
+        simulateDrive(distance, traces.back());
+    }
+    return traces;
+}
+
+// Run all host benchmarks
+void runBenchmarks() {
+    benchmarkQuinticSolvers();
+    benchmarkProfileSampler();
+    benchmarkContinuousSpline();
+    benchmarkArcLength();
+    benchmarkPathSearch();
+    benchmarkBezierPath();
+    benchmarkVelocityProfile();
+    benchmarkTurnProfile();
+    benchmarkBoomerang();
+    benchmarkTimeAlignment();
+    benchmarkSidewaysOdometry();
+    benchmarkPoseFilter();
+    benchmarkRelocalize();
+    benchmarkParticleFilter();
+    benchmarkPoseHistory();
+}
+
+// Sweep RAMSETE b/zeta and the voltage caps over a simulated drivetrain that is a little
+// off from the feedforward model, and report the best tracking. A drivetrain that matches
+// the model exactly has to follow the plan first; if it cannot, the plan is not something
+// a robot can drive and no gains found against it mean anything.
+int sweepGains(const std::vector<TrajectorySegment>& segments, const std::vector<double>& maxVoltages,
+               const DriveModel& model, double track_width, double dt) {
+    SimulatedDrive ideal = {model};
+    SimulatedLoop idealLoop = {dt};
+    PathResult check = executePath(segments, maxVoltages, model, {2.0, 0.7}, track_width, ideal, idealLoop);
+    std::cout << "Ideal drive: rms " << check.rmsError << " m, max " << check.maxError << " m, final "
+              << check.finalError << " m\n";
+    if (check.maxError > 0.05) {
+        std::cerr << "The plan cannot be tracked even with a perfect model, not sweeping\n";
+        return 1;
+    }
+
+    DriveModel plant = {{0.4, 12.3, 1.8}, {0.35, 12.0, 1.7}};
+
+    std::vector<SweepCase> cases;
+    for (int bi = 0; bi < 20; ++bi) {
+        for (int zi = 0; zi < 20; ++zi) {
+            for (double voltageScale : {0.7, 0.85, 1.0}) {
+                cases.push_back({{0.5 + bi * 0.25, 0.1 + zi * 0.045}, voltageScale, {}});
+            }
+        }
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    runSweep(cases, segments, maxVoltages, model, plant, track_width, dt);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::sort(cases.begin(), cases.end(), [](const SweepCase& a, const SweepCase& b) {
+        return a.result.rmsError < b.result.rmsError;
+    });
+    std::cout << "Swept " << cases.size() << " rollouts on " << std::max(1u, std::thread::hardware_concurrency())
+              << " threads in " << seconds << "s\n";
+    for (size_t i = 0; i < std::min<size_t>(5, cases.size()); ++i) {
+        const SweepCase& c = cases[i];
+        std::cout << "b " << c.gains.b << ", zeta " << c.gains.zeta << ", voltage x" << c.voltageScale
+                  << ": rms " << c.result.rmsError << " m, max " << c.result.maxError << " m, final "
+                  << c.result.finalError << " m\n";
+    }
+    return 0;
+}
+
 // Main function
-int main() {
-    double tf = 5.0; // Time per segment
-    int steps = 100; // Points per path
+int main(int argc, char** argv) {
     double track_width = 0.5; // Meters
-    double dt = tf / steps;
+    double dt = 0.05; // Control period, seconds
+    DriveLimits limits = {1.0, 2.0}; // 1 m/s at 12V, 2 m/s^2
+    DriveModel model = {{0.3, 11.7, 1.5}, {0.3, 11.7, 1.5}}; // kS, kV, kA per side
+    // The robot's, for assets it will play: followConstants' 60 in/s and 80 in/s^2, 10 in track
+    DriveLimits robotLimits = {60 * 0.0254, 80 * 0.0254};
+    double robotTrackWidth = 10 * 0.0254;
+
+    if (argc > 1 && std::strcmp(argv[1], "--bench") == 0) {
+        runBenchmarks();
+        return 0;
+    }
+
+    // riderlib --settle [traces.csv]
+    if (argc > 1 && std::strcmp(argv[1], "--settle") == 0) {
+        return replaySettle(argc > 2 ? readSettleTraces(argv[2]) : simulatedSettleTraces());
+    }
+    // riderlib --compile <spec> <out.bin> [dt]
+    if (argc > 3 && std::strcmp(argv[1], "--compile") == 0) {
+        return compileTrajectory(argv[2], argv[3], robotLimits, robotTrackWidth, argc > 4 ? std::atof(argv[4]) : 0.01);
+    }
 
-    std::vector<std::vector<MotionProfile>> waypoints;
     std::vector<double> maxVoltages = {12.0, 6.0, 10.0}; // Different voltages per movement
 
-    // Define 3 movement segments with different voltage caps
-    std::vector<std::pair<Pose, Pose>> targets = {
-        {{0, 0, 0}, {2, 1, M_PI/4}}, // Move to (2,1) with 45°
-        {{2, 1, M_PI/4}, {4, 2, M_PI/2}}, // Move to (4,2) with 90°
-        {{4, 2, M_PI/2}, {5, 3, M_PI}} // Move to (5,3) with 180°
+    // Pass through 3 targets with different voltage caps. The robot heads along the path,
+    // so each theta only shapes the spline's theta channel
+    std::vector<Pose> waypoints = {
+        {0, 0, 0},
+        {2, 1, M_PI/4}, // Through (2,1)
+        {4, 2, M_PI/2}, // Through (4,2)
+        {5, 3, M_PI} // End at (5,3)
     };
 
-    for (auto& [start, end] : targets) {
-        QuinticCoeffs xC = computeQuinticSpline(start.x, 0, 0, end.x, 0, 0, tf);
-        QuinticCoeffs yC = computeQuinticSpline(start.y, 0, 0, end.y, 0, 0, tf);
-        QuinticCoeffs thetaC = computeQuinticSpline(start.theta, 0, 0, end.theta, 0, 0, tf);
+    std::vector<TrajectorySegment> segments = planContinuousPath(waypoints, maxVoltages, limits, track_width, dt);
+    for (size_t i = 0; i < segments.size(); ++i) {
+        std::cout << "Segment " << i << " (leg " << segments[i].leg << "): " << segments[i].tf << "s\n";
+    }
 
-        waypoints.push_back(generateMotionProfile(xC, yC, thetaC, tf, steps));
+    if (argc > 1 && std::strcmp(argv[1], "--sweep") == 0) {
+        return sweepGains(segments, maxVoltages, model, track_width, dt);
     }
 
-    executePath(waypoints, maxVoltages, track_width, dt);
+    PrintDrive drive;
+    if (argc > 1 && std::strcmp(argv[1], "--realtime") == 0) {
+        PeriodicLoop loop(dt);
+        executePath(segments, maxVoltages, model, {2.0, 0.7}, track_width, drive, loop);
+        loop.statistics().print(dt);
+    } else {
+        SimulatedLoop loop = {dt};
+        executePath(segments, maxVoltages, model, {2.0, 0.7}, track_width, drive, loop);
+    }
     return 0;
 }
+#endif